@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <numeric>
+
+#include "Utils.hpp"
+#include "Bench.hpp"
+
+namespace fire::bench {
+
+  static double now_ms() {
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+  }
+
+  // two-sided 95% critical value of Student's t.
+  static double t_value(size_t df) {
+    static constexpr double table[] = {
+        0,     12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179,  2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086, 2.080,
+        2.074, 2.069,  2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+    };
+
+    if (df < std::size(table))
+      return table[df];
+
+    if (df < 60)
+      return 2.000;
+
+    if (df < 120)
+      return 1.980;
+
+    return 1.960;
+  }
+
+  Result Runner::measure(Case const& c) {
+    auto once = [&c] {
+      if (c.setup)
+        c.setup();
+
+      auto begin = now_ms();
+      c.run();
+      auto t = now_ms() - begin;
+
+      if (c.teardown)
+        c.teardown();
+
+      return t;
+    };
+
+    for (size_t i = 0; i < opts.warmup; i++)
+      once();
+
+    Result r{.name = c.name, .bytes = c.bytes};
+
+    double total = 0;
+    size_t max_samples = c.max_samples ? std::min(c.max_samples, opts.max_samples) : opts.max_samples;
+
+    while (r.samples_ms.size() < max_samples &&
+           (r.samples_ms.size() < std::min(opts.min_samples, max_samples) || total < opts.min_time_ms)) {
+      auto t = once();
+      r.samples_ms.push_back(t);
+      total += t;
+    }
+
+    auto n = r.samples_ms.size();
+    auto sorted = r.samples_ms;
+
+    std::sort(sorted.begin(), sorted.end());
+
+    r.mean = total / n;
+    r.min = sorted.front();
+    r.max = sorted.back();
+    r.median = n % 2 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+
+    if (n > 1) {
+      double sq = 0;
+
+      for (auto t : r.samples_ms)
+        sq += (t - r.mean) * (t - r.mean);
+
+      r.stddev = std::sqrt(sq / (n - 1));
+      r.ci95 = t_value(n - 1) * r.stddev / std::sqrt((double)n);
+    }
+
+    return r;
+  }
+
+  void Runner::print_header() {
+    std::printf("%-36s %7s %12s %16s %12s %12s %12s\n", "benchmark", "samples", "mean(ms)",
+                "95% CI", "stddev(ms)", "median(ms)", "MiB/s");
+  }
+
+  void Runner::print(Result const& r) {
+    auto rel = r.mean > 0 ? r.ci95 / r.mean * 100 : 0;
+
+    std::printf("%-36s %7zu %12.4f %9.4f %5.1f%% %12.4f %12.4f", r.name.c_str(), r.samples_ms.size(),
+                r.mean, r.ci95, rel, r.stddev, r.median);
+
+    if (r.bytes)
+      std::printf(" %12.2f", r.bytes / (1024.0 * 1024.0) / (r.mean / 1000));
+    else
+      std::printf(" %12s", "-");
+
+    std::printf("\n");
+    std::fflush(stdout);
+  }
+
+  void Runner::write_json(std::string const& path, std::vector<Result> const& results) {
+    auto fp = std::fopen(path.c_str(), "w");
+
+    if (!fp) {
+      std::fprintf(stderr, "cannot open file: %s\n", path.c_str());
+      return;
+    }
+
+    std::fprintf(fp, "{\"benchmarks\": [");
+
+    for (size_t i = 0; i < results.size(); i++) {
+      auto const& r = results[i];
+
+      std::fprintf(fp,
+                   "%s\n  {\"name\": %s, \"bytes\": %zu, \"samples\": %zu, \"mean_ms\": %.6f, "
+                   "\"ci95_ms\": %.6f, \"stddev_ms\": %.6f, \"median_ms\": %.6f, "
+                   "\"min_ms\": %.6f, \"max_ms\": %.6f}",
+                   i ? "," : "", json_string(r.name).c_str(), r.bytes, r.samples_ms.size(), r.mean,
+                   r.ci95, r.stddev, r.median, r.min, r.max);
+    }
+
+    std::fprintf(fp, "\n]}\n");
+
+    std::fclose(fp);
+  }
+
+  int Runner::run() {
+    std::vector<Result> results;
+
+    if (!opts.list)
+      print_header();
+
+    for (auto const& c : cases) {
+      if (!opts.filter.empty() && c.name.find(opts.filter) == std::string::npos)
+        continue;
+
+      if (opts.list) {
+        std::printf("%s\n", c.name.c_str());
+        continue;
+      }
+
+      results.emplace_back(measure(c));
+      print(results.back());
+    }
+
+    if (!opts.json_path.empty())
+      write_json(opts.json_path, results);
+
+    return 0;
+  }
+
+} // namespace fire::bench
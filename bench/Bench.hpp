@@ -0,0 +1,91 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace fire::bench {
+
+  //
+  // Case
+  //   one benchmark.
+  //   only "run" is timed. "setup" and "teardown" are called around each sample,
+  //   so a case can parse a fresh module or free tokens without measuring it.
+  struct Case {
+    std::string name;
+
+    // bytes processed by one run. (0 = no throughput)
+    size_t bytes = 0;
+
+    // limit of samples, for cases which leak. (0 = Options::max_samples)
+    size_t max_samples = 0;
+
+    std::function<void()> setup;
+    std::function<void()> run;
+    std::function<void()> teardown;
+  };
+
+  struct Result {
+    std::string name;
+    size_t bytes = 0;
+
+    std::vector<double> samples_ms;
+
+    double mean = 0;
+    double stddev = 0;
+    double ci95 = 0; // half width of 95% confidence interval of mean
+    double median = 0;
+    double min = 0;
+    double max = 0;
+  };
+
+  struct Options {
+    std::string filter;    // run only cases whose name contains this
+    std::string json_path; // write results as JSON
+    size_t warmup = 2;
+    size_t min_samples = 10;
+    size_t max_samples = 200;
+    double min_time_ms = 1000;
+    bool list = false;
+  };
+
+  //
+  // Runner
+  //   repeats each case until it has enough samples and time, and reports
+  //   mean ± 95% CI (Student's t) for comparison between builds.
+  class Runner {
+    std::vector<Case> cases;
+
+  public:
+    Options opts;
+
+    void add(Case c) {
+      cases.emplace_back(std::move(c));
+    }
+
+    int run();
+
+  private:
+    Result measure(Case const& c);
+
+    static void print_header();
+    static void print(Result const& r);
+
+    static void write_json(std::string const& path, std::vector<Result> const& results);
+  };
+
+  // defined in FrontEnd.cpp / ParserPasses.cpp / Runtime.cpp / Strconv.cpp / Strings.cpp
+  void add_frontend_cases(Runner& R);
+  void add_lsp_cases(Runner& R);
+  void add_parser_pass_cases(Runner& R);
+  void add_runtime_cases(Runner& R);
+  void add_strconv_cases(Runner& R);
+  void add_string_cases(Runner& R);
+
+  // prevent the compiler from removing a result.
+  template <typename T>
+  inline void keep(T const& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+  }
+
+} // namespace fire::bench
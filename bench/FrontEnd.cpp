@@ -0,0 +1,122 @@
+#include <memory>
+
+#include "Utils.hpp"
+#include "Token.hpp"
+#include "Lexer.hpp"
+#include "Parser.hpp"
+#include "Sema.hpp"
+
+#include "Bench.hpp"
+#include "Synth.hpp"
+
+//
+// benchmarks of lexer, parser and sema on generated sources.
+// parsed nodes are never freed in the compiler, so cases that parse
+// keep their sources small and limit count of samples.
+
+namespace fire::bench {
+
+  static constexpr size_t LeakingMaxSamples = 30;
+
+  static SourceFile* make_source(std::string const& name, std::string data) {
+    return new SourceFile("<bench>/" + name + ".fire", std::move(data));
+  }
+
+  static SourceFile* make_source(std::string const& name, Synth::Config conf) {
+    return make_source(name, Synth(conf).generate());
+  }
+
+  //
+  // a data table of numbers.
+  //   var table_N = [ 12345, 0.125, ... ];
+  static std::string number_table(size_t rows, size_t cols) {
+    std::string s;
+
+    for (size_t i = 0; i < rows; i++) {
+      s += format("var table_%zu = [", i);
+
+      for (size_t j = 0; j < cols; j++) {
+        auto n = (i * cols + j) * 2654435761u % 1000003;
+
+        s += j % 2 ? format("%zu.%03zu, ", n, n % 1000) : format("%zu, ", n);
+      }
+
+      s += "0];\n";
+    }
+
+    return s;
+  }
+
+  static void free_tokens(Token* tok) {
+    while (tok) {
+      auto next = tok->next;
+      delete tok;
+      tok = next;
+    }
+  }
+
+  static void add_lex(Runner& R, std::string const& name, SourceFile* src) {
+    auto tok = std::make_shared<Token*>();
+
+    R.add({
+        .name = "lex/" + name,
+        .bytes = src->length,
+        .run = [=] { *tok = Lexer(src).lex(); },
+        .teardown = [=] { free_tokens(*tok); },
+    });
+  }
+
+  static void add_parse(Runner& R, std::string const& name, SourceFile* src) {
+    auto tok = std::make_shared<Token*>();
+
+    R.add({
+        .name = "parse/" + name,
+        .bytes = src->length,
+        .max_samples = LeakingMaxSamples,
+        .setup = [=] { *tok = Lexer(src).lex(); },
+        .run = [=] { keep(Parser(*src, *tok).parse()); },
+    });
+  }
+
+  static void add_sema(Runner& R, std::string const& name, Synth::Config conf, size_t jobs) {
+    auto src = make_source(name, conf);
+    auto mod = std::make_shared<NdModule*>();
+
+    R.add({
+        .name = "sema/" + name,
+        .bytes = src->length,
+        .max_samples = LeakingMaxSamples,
+        .setup =
+            [=] {
+              Sema::get_instance().set_jobs(jobs);
+              *mod = Parser(*src, Lexer(src).lex()).parse();
+              (*mod)->name = "__main__";
+            },
+        .run = [=] { Sema::analyze_all(*mod); },
+    });
+  }
+
+  void add_frontend_cases(Runner& R) {
+    auto numbers = make_source("numbers", number_table(200, 500));
+
+    add_lex(R, "flat-4000fn", make_source("flat-4000fn", {.functions = 4000, .classes = 200, .enums = 200}));
+    add_lex(R, "nest-64",
+            make_source("nest-64", {.functions = 8, .classes = 4, .enums = 0, .namespace_depth = 64}));
+    add_lex(R, "numbers", numbers);
+
+    add_parse(R, "flat-500fn", make_source("flat-500fn", {.functions = 500, .classes = 50, .enums = 50}));
+    add_parse(R, "nest-32",
+              make_source("nest-32", {.functions = 8, .classes = 4, .enums = 0, .namespace_depth = 32}));
+    add_parse(R, "ns-blocks-500",
+              make_source("ns-blocks-500", {.functions = 500, .classes = 0, .enums = 0, .namespace_depth = 2,
+                                      .namespace_blocks = 500, .expr_depth = 0}));
+    add_parse(R, "numbers", numbers);
+
+    add_sema(R, "flat-400fn", {.functions = 400, .classes = 40, .enums = 20}, 1);
+    add_sema(R, "flat-400fn-parallel", {.functions = 400, .classes = 40, .enums = 20}, 0);
+    add_sema(R, "nest-32", {.functions = 4, .classes = 2, .enums = 0, .namespace_depth = 32}, 1);
+    add_sema(R, "nest-128", {.functions = 2, .classes = 1, .enums = 0, .namespace_depth = 128}, 1);
+    add_sema(R, "expr-depth-64", {.functions = 100, .classes = 0, .enums = 0, .expr_depth = 64}, 1);
+  }
+
+} // namespace fire::bench
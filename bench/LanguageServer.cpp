@@ -0,0 +1,71 @@
+#include <memory>
+
+#include "LanguageServer.hpp"
+
+#include "Bench.hpp"
+#include "Synth.hpp"
+
+//
+// benchmarks of documents of the language server.
+// an edit is made and undone in turns, so each run analyzes a changed text.
+
+namespace fire::bench {
+
+  static constexpr size_t DocumentMaxSamples = 30;
+
+  static void add_open(Runner& R, std::string const& name, std::string text) {
+    auto size = text.length();
+
+    R.add({
+        .name = "lsp/open/" + name,
+        .bytes = size,
+        .max_samples = DocumentMaxSamples,
+        .run =
+            [=] {
+              LSP::Document doc("<bench>/" + name + ".fire", text);
+              doc.update();
+              keep(doc.get_diagnostics().size());
+            },
+    });
+  }
+
+  //
+  // edit in body of the function. (statement is inserted and removed)
+  static void add_edit(Runner& R, std::string const& name, std::string text,
+                       std::string const& func) {
+    auto doc = std::make_shared<LSP::Document>("<bench>/" + name + ".fire", text);
+    auto inserted = std::make_shared<bool>(false);
+
+    std::string const stmt = "  var edited = 1;\n";
+    size_t pos = text.find("{\n", text.find("fn " + func + "(")) + 2;
+
+    doc->update();
+
+    R.add({
+        .name = "lsp/edit/" + name,
+        .bytes = text.length(),
+        .max_samples = DocumentMaxSamples * 10,
+        .setup =
+            [=] {
+              if (*inserted)
+                doc->edit(pos, pos + stmt.length(), "");
+              else
+                doc->edit(pos, pos, stmt);
+
+              *inserted = !*inserted;
+            },
+        .run = [=] { doc->update(); },
+    });
+  }
+
+  void add_lsp_cases(Runner& R) {
+    auto flat = Synth({.functions = 400, .classes = 40, .enums = 20}).generate();
+
+    add_open(R, "flat-400fn", flat);
+
+    // f0 is called from main only. f399 is called from all functions. (transitively)
+    add_edit(R, "flat-400fn-leaf", flat, "f0");
+    add_edit(R, "flat-400fn-root", flat, "f399");
+  }
+
+} // namespace fire::bench
@@ -0,0 +1,150 @@
+#include <memory>
+
+#include "Utils.hpp"
+#include "Lexer.hpp"
+#include "Parser.hpp"
+
+#include "Bench.hpp"
+
+//
+// merge_namespaces and reorder_items, compared with the old implementations.
+// (restarting merge and five passes of reordering)
+
+namespace fire::bench {
+
+  static void old_merge_namespaces(std::vector<Node*>& items) {
+    bool flag = false;
+
+  __begin__:;
+    flag = false;
+    for (size_t i = 0; i < items.size();) {
+      if (auto orig = items[i]->as<NdNamespace>(); orig->is(NodeKind::Namespace)) {
+        for (size_t j = i + 1; j < items.size(); j++) {
+          if (auto dup = items[j]->as<NdNamespace>();
+              dup->is(NodeKind::Namespace) && dup->name == orig->name) {
+            for (auto x : dup->items)
+              orig->items.push_back(x);
+            delete dup;
+            items.erase(items.begin() + j);
+            flag = true;
+            goto __merged;
+          }
+        }
+        i++;
+      __merged:;
+      } else {
+        i++;
+      }
+    }
+
+    if (flag)
+      goto __begin__;
+
+    for (auto&& x : items) {
+      if (x->is(NodeKind::Namespace))
+        old_merge_namespaces(x->as<NdNamespace>()->items);
+    }
+  }
+
+  static void old_reorder_items(std::vector<Node*>& items) {
+    std::vector<Node*> _new;
+
+    for (NodeKind kind : {NodeKind::Let, NodeKind::Namespace, NodeKind::Enum, NodeKind::Class,
+                          NodeKind::Function}) {
+      for (auto&& x : items)
+        if (x->is(kind))
+          _new.push_back(x);
+    }
+
+    items = std::move(_new);
+
+    for (auto&& x : items) {
+      if (x->is(NodeKind::Namespace))
+        old_reorder_items(x->as<NdNamespace>()->items);
+    }
+  }
+
+  //
+  // "blocks" namespace blocks with "names" different names, like a namespace
+  // opened in many files. each block has a nested namespace too.
+  static std::string namespace_blocks(size_t blocks, size_t names) {
+    std::string s;
+
+    for (size_t i = 0; i < blocks; i++) {
+      s += format("namespace n%zu { fn f%zu() -> int { } namespace m%zu { fn g%zu() -> int { } } }\n",
+                  i % names, i, i % 3, i);
+      s += format("fn h%zu() -> int { }\n", i);
+    }
+
+    return s;
+  }
+
+  static std::string mixed_items(size_t count) {
+    std::string s;
+
+    for (size_t i = 0; i < count; i++) {
+      switch (i % 5) {
+        case 0:
+          s += format("fn f%zu() -> int { }\n", i);
+          break;
+        case 1:
+          s += format("class C%zu { var x: int; }\n", i);
+          break;
+        case 2:
+          s += format("enum E%zu { A, B }\n", i);
+          break;
+        case 3:
+          s += format("var v%zu: int = %zu;\n", i, i);
+          break;
+        case 4:
+          s += format("namespace n%zu { fn g() -> int { } }\n", i);
+          break;
+      }
+    }
+
+    return s;
+  }
+
+  using Pass = void (*)(std::vector<Node*>&);
+
+  // merge destroys the items, so parse again for each sample.
+  static void add_merge(Runner& R, std::string const& name, std::string const& source, Pass pass) {
+    auto src = new SourceFile("<bench>/" + name + ".fire", source);
+    auto mod = std::make_shared<NdModule*>();
+
+    R.add({
+        .name = "merge-namespaces/" + name,
+        .max_samples = 30,
+        .setup = [=] { *mod = Parser(*src, Lexer(src).lex()).ps_mod(); },
+        .run = [=] { pass((*mod)->items); },
+    });
+  }
+
+  static void add_reorder(Runner& R, std::string const& name, std::string const& source, Pass pass) {
+    auto src = new SourceFile("<bench>/" + name + ".fire", source);
+    auto mod = Parser(*src, Lexer(src).lex()).ps_mod();
+    auto items = std::make_shared<std::vector<Node*>>();
+
+    R.add({
+        .name = "reorder-items/" + name,
+        .setup = [=] { *items = mod->items; },
+        .run = [=] { pass(*items); },
+    });
+  }
+
+  void add_parser_pass_cases(Runner& R) {
+    for (auto [blocks, names] : {std::pair{1000, 10}, std::pair{4000, 400}}) {
+      auto source = namespace_blocks(blocks, names);
+      auto name = format("%zux%zu", (size_t)blocks, (size_t)names);
+
+      add_merge(R, "old-" + name, source, old_merge_namespaces);
+      add_merge(R, "new-" + name, source, Parser::merge_namespaces);
+    }
+
+    auto source = mixed_items(20000);
+
+    add_reorder(R, "old-20000", source, old_reorder_items);
+    add_reorder(R, "new-20000", source, Parser::reorder_items);
+  }
+
+} // namespace fire::bench
@@ -0,0 +1,220 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "Utils.hpp"
+#include "Object.hpp"
+#include "Output.hpp"
+#include "StringBuilder.hpp"
+#include "BuiltinFunc.hpp"
+#include "strconv.hpp"
+
+#include "Bench.hpp"
+
+//
+// benchmarks of runtime objects.
+//
+// there is no interpreter yet, so workloads of Fire programs (fib, nbody,
+// dict lookup) will be added here when the VM can run them. until then these
+// measure the operations such programs are made of.
+
+namespace fire::bench {
+
+  static void add_string_build(Runner& R, size_t count) {
+    R.add({
+        .name = "runtime/string-build-" + std::to_string(count),
+        .bytes = count * sizeof(char16_t),
+        .run =
+            [=] {
+              ObjString str;
+              ObjChar ch(u'a');
+
+              for (size_t i = 0; i < count; i++) {
+                ch.val = u'a' + i % 26;
+                str.append(&ch);
+              }
+
+              keep(str.data);
+            },
+    });
+  }
+
+  static void add_string_concat(Runner& R, size_t count) {
+    R.add({
+        .name = "runtime/string-concat-" + std::to_string(count),
+        .run =
+            [=] {
+              ObjString str;
+              ObjString part(std::vector<char16_t>(16, u'x'));
+
+              for (size_t i = 0; i < count; i++)
+                str.append(&part);
+
+              keep(str.data);
+            },
+    });
+  }
+
+  //
+  // "s = s + part" in a loop:
+  //   copy:    new string for each "+"
+  //   builder: StringBuilder (what Sema picks in loops)
+  static void add_string_concat_loop(Runner& R, size_t count) {
+    auto part = std::make_shared<ObjString>(std::vector<char16_t>(16, u'x'));
+
+    R.add({
+        .name = "runtime/string-concat-loop-copy-" + std::to_string(count),
+        .bytes = count * 16 * sizeof(char16_t),
+        .run =
+            [=] {
+              ObjString* s = new ObjString();
+
+              for (size_t i = 0; i < count; i++) {
+                auto t = ObjString::concat(s, part.get());
+                delete s;
+                s = t;
+              }
+
+              keep(s->data);
+              delete s;
+            },
+    });
+
+    R.add({
+        .name = "runtime/string-concat-loop-builder-" + std::to_string(count),
+        .bytes = count * 16 * sizeof(char16_t),
+        .run =
+            [=] {
+              StringBuilder sb;
+
+              for (size_t i = 0; i < count; i++)
+                sb.append(part.get());
+
+              auto s = sb.finish();
+              keep(s->data);
+              delete s;
+            },
+    });
+  }
+
+  static void add_vector_append(Runner& R, size_t count) {
+    R.add({
+        .name = "runtime/vector-append-" + std::to_string(count),
+        .run =
+            [=] {
+              ObjVector vec;
+
+              for (size_t i = 0; i < count; i++)
+                vec.append(new ObjInt(i));
+
+              for (auto obj : vec.data)
+                delete obj;
+            },
+    });
+  }
+
+  static void add_to_string(Runner& R, size_t count) {
+    R.add({
+        .name = "runtime/to-string-" + std::to_string(count),
+        .run =
+            [=] {
+              ObjString s(std::vector<char16_t>(32, u'x'));
+
+              for (size_t i = 0; i < count; i++) {
+                ObjInt n(i * 7919); // ints are immutable
+                keep(n.to_string());
+                keep(s.to_string());
+              }
+            },
+    });
+  }
+
+  // what println does for each value, into /dev/null.
+  static void add_print(Runner& R, size_t lines) {
+    int fd = open("/dev/null", O_WRONLY);
+
+    R.add({
+        .name = "runtime/println-" + std::to_string(lines),
+        .run =
+            [=] {
+              Output out(fd);
+              ObjFloat f(0);
+              ObjString s(std::vector<char16_t>(16, u'x'));
+
+              for (size_t i = 0; i < lines; i++) {
+                ObjInt n(i * 7919); // ints are immutable
+                f.val = i * 0.5;
+
+                for (Object* obj : {(Object*)&n, (Object*)&f, (Object*)&s}) {
+                  out.write_object(obj);
+                  out.write(' ');
+                }
+
+                out.newline();
+              }
+            },
+    });
+  }
+
+  //
+  // string::starts in a loop, by each way to call a builtin:
+  //   vector: arguments boxed into a new std::vector (the old convention)
+  //   slots:  span of argument slots and a result slot
+  //   fast:   fixed arity entry point
+  static void add_builtin_call(Runner& R, size_t count) {
+    auto f = BuiltinRegistry::get_instance().find_method(TypeKind::String, "starts");
+
+    auto self = std::make_shared<ObjString>(std::vector<char16_t>(32, u'x'));
+    auto prefix = std::make_shared<ObjString>(std::vector<char16_t>(8, u'x'));
+
+    auto name = [=](char const* how) {
+      return format("runtime/builtin-call-%s-%zu", how, count);
+    };
+
+    R.add({
+        .name = name("vector"),
+        .run =
+            [=] {
+              Object* result = nullptr;
+
+              for (size_t i = 0; i < count; i++) {
+                std::vector<Object*> args{self.get(), prefix.get()};
+                f->impl(args.data(), args.size(), result);
+                keep(result);
+              }
+            },
+    });
+
+    R.add({
+        .name = name("slots"),
+        .run =
+            [=] {
+              Object* regs[3] = {self.get(), prefix.get(), nullptr};
+
+              for (size_t i = 0; i < count; i++) {
+                f->impl(regs, 2, regs[2]);
+                keep(regs[2]);
+              }
+            },
+    });
+
+    R.add({
+        .name = name("fast"),
+        .run =
+            [=] {
+              for (size_t i = 0; i < count; i++)
+                keep(f->fast2(self.get(), prefix.get()));
+            },
+    });
+  }
+
+  void add_runtime_cases(Runner& R) {
+    add_string_build(R, 100000);
+    add_string_concat(R, 10000);
+    add_string_concat_loop(R, 5000);
+    add_vector_append(R, 100000);
+    add_to_string(R, 10000);
+    add_print(R, 100000);
+    add_builtin_call(R, 1000000);
+  }
+
+} // namespace fire::bench
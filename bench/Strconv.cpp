@@ -0,0 +1,70 @@
+#include <memory>
+
+#include "Utils.hpp"
+#include "strconv.hpp"
+
+#include "Bench.hpp"
+
+//
+// UTF-8 <-> UTF-16 transcoders, with each implementation the cpu can run.
+// (ascii, mixed latin and japanese text, and source code with non-ascii comments)
+
+namespace fire::bench {
+
+  static std::string make_text(char const* piece, size_t bytes) {
+    std::string s;
+
+    while (s.size() < bytes)
+      s += piece;
+
+    return s;
+  }
+
+  static void add_text(Runner& R, std::string const& name, std::string const& text) {
+    auto u8 = std::make_shared<std::string>(text);
+    auto u16 = std::make_shared<std::u16string>(utf8_to_utf16_len_cpp(u8->data(), u8->size()));
+
+    auto out16 = std::make_shared<std::u16string>(u16->size() + 1, 0);
+    auto out8 = std::make_shared<std::string>(u8->size() + 1, 0);
+
+    auto default_impl = strconv_get_impl();
+
+    for (auto impl : {STRCONV_SCALAR, STRCONV_SSE4, STRCONV_AVX2}) {
+      if (!strconv_set_impl(impl))
+        continue;
+
+      std::string suffix = "-" + name + "/" + strconv_impl_name(impl);
+
+      R.add({
+          .name = "strconv/utf8-to-utf16" + suffix,
+          .bytes = u8->size(),
+          .setup = [=] { strconv_set_impl(impl); },
+          .run = [=] { keep(utf8_to_utf16_with_len(out16->data(), u8->data(), u8->size())); },
+          .teardown = [=] { strconv_set_impl(default_impl); },
+      });
+
+      R.add({
+          .name = "strconv/utf16-to-utf8" + suffix,
+          .bytes = u16->size() * sizeof(char16_t),
+          .setup = [=] { strconv_set_impl(impl); },
+          .run = [=] { keep(utf16_to_utf8_with_len(out8->data(), u16->data(), u16->size())); },
+          .teardown = [=] { strconv_set_impl(default_impl); },
+      });
+    }
+
+    strconv_set_impl(default_impl);
+  }
+
+  void add_strconv_cases(Runner& R) {
+    size_t const size = 1 << 20;
+
+    add_text(R, "ascii", make_text("fn main() -> int { println(\"hello, world\"); }\n", size));
+    add_text(R, "latin", make_text("Größe façade naïve déjà vu, ", size));
+    add_text(R, "japanese", make_text("こんにちは、世界。", size));
+    add_text(R, "code",
+             make_text("fn main() -> int {\n  // 挨拶を表示する\n  println(\"hello, world\");\n"
+                       "  var sum = 0;\n  for i in 0..10 {\n    sum += i;\n  }\n}\n",
+                       size));
+  }
+
+} // namespace fire::bench
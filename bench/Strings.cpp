@@ -0,0 +1,122 @@
+#include <memory>
+#include <string_view>
+
+#include "Utils.hpp"
+#include "Object.hpp"
+#include "BuiltinFunc.hpp"
+#include "strconv.hpp"
+#include "strsearch.hpp"
+
+#include "Bench.hpp"
+
+//
+// string builtins on large inputs.
+// substring search is run with each implementation the cpu can run, and
+// with std::u16string_view::find as the baseline.
+
+namespace fire::bench {
+
+  static ObjString* make_string(std::u16string_view s) {
+    return new ObjString(std::vector<char16_t>(s.begin(), s.end()));
+  }
+
+  // text without the needle, and the needle at the end.
+  static std::u16string make_haystack(size_t len, std::u16string_view needle) {
+    std::u16string s;
+
+    for (size_t i = 0; s.size() + needle.size() < len; i++)
+      s += u"the quick brown fox jumps over the lazy dog. いろはにほへと ";
+
+    s.resize(len - needle.size());
+    s += needle;
+
+    return s;
+  }
+
+  static void add_search(Runner& R, std::u16string_view needle, char const* name) {
+    auto hay = std::make_shared<std::u16string>(make_haystack(1 << 20, needle));
+    auto pat = std::make_shared<std::u16string>(needle);
+
+    size_t bytes = hay->size() * sizeof(char16_t);
+
+    R.add({
+        .name = format("string/find-%s/std", name),
+        .bytes = bytes,
+        .run = [=] { keep(std::u16string_view(*hay).find(*pat)); },
+    });
+
+    auto default_impl = strconv_get_impl();
+
+    for (auto impl : {STRCONV_SCALAR, STRCONV_SSE4, STRCONV_AVX2}) {
+      if (!strconv_set_impl(impl))
+        continue;
+
+      R.add({
+          .name = format("string/find-%s/%s", name, strconv_impl_name(impl)),
+          .bytes = bytes,
+          .setup = [=] { strconv_set_impl(impl); },
+          .run = [=] { keep(u16_find(hay->data(), hay->size(), pat->data(), pat->size())); },
+          .teardown = [=] { strconv_set_impl(default_impl); },
+      });
+    }
+
+    strconv_set_impl(default_impl);
+  }
+
+  static Object* call(char const* method, std::vector<Object*> args) {
+    Object* result = nullptr;
+
+    BuiltinRegistry::get_instance().find_method(TypeKind::String, method)->impl(args.data(), args.size(),
+                                                                                 result);
+
+    return result;
+  }
+
+  static void free_strings(Object* vec) {
+    for (auto s : vec->as<ObjVector>()->data)
+      delete s;
+
+    delete vec;
+  }
+
+  static void add_builtins(Runner& R) {
+    std::u16string csv;
+
+    while (csv.size() < (1 << 20))
+      csv += u"2024-01-01,tokyo,12.5,sunny\n";
+
+    auto text = std::shared_ptr<ObjString>(make_string(csv));
+    auto comma = std::shared_ptr<ObjString>(make_string(u","));
+    auto tokyo = std::shared_ptr<ObjString>(make_string(u"tokyo"));
+    auto osaka = std::shared_ptr<ObjString>(make_string(u"osaka"));
+
+    size_t bytes = csv.size() * sizeof(char16_t);
+
+    R.add({
+        .name = "string/split-csv",
+        .bytes = bytes,
+        .run = [=] { free_strings(call("split", {text.get(), comma.get()})); },
+    });
+
+    R.add({
+        .name = "string/replace-csv",
+        .bytes = bytes,
+        .run = [=] { delete call("replace", {text.get(), tokyo.get(), osaka.get()}); },
+    });
+
+    R.add({
+        .name = "string/rfind-csv",
+        .bytes = bytes,
+        .run = [=] { keep(call("rfind", {text.get(), osaka.get()})); },
+    });
+  }
+
+  void add_string_cases(Runner& R) {
+    add_search(R, u"#", "1");
+    add_search(R, u"needle", "6");
+    add_search(R, u"a needle in the haystack", "24");
+
+    add_builtins(R);
+  }
+
+} // namespace fire::bench
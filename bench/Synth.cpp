@@ -0,0 +1,225 @@
+#include <algorithm>
+#include <iterator>
+
+#include "Utils.hpp"
+#include "Synth.hpp"
+
+namespace fire::bench {
+
+  std::string Synth::generate() {
+    rng.seed(conf.seed);
+
+    return gen_main({});
+  }
+
+  std::vector<Synth::File> Synth::generate_files() {
+    rng.seed(conf.seed);
+
+    std::vector<File> files;
+
+    files.push_back({"main.fire", gen_main(imports_of(-1))});
+
+    for (size_t i = 0; i < conf.modules; i++)
+      files.push_back({format("mod%zu.fire", i), gen_module(i, imports_of(i))});
+
+    return files;
+  }
+
+  //
+  // imports of a module make a tree with "import_fanout" children.
+  // (index -1 = main)
+  std::vector<size_t> Synth::imports_of(long index) const {
+    std::vector<size_t> ret;
+    size_t fanout = std::max<size_t>(conf.import_fanout, 1);
+    size_t first = (index + 1) * fanout;
+
+    for (size_t i = first; i < first + fanout && i < conf.modules; i++)
+      ret.push_back(i);
+
+    return ret;
+  }
+
+  std::string Synth::gen_main(std::vector<size_t> const& imports) {
+    out.clear();
+
+    for (auto i : imports)
+      out += format("import mod%zu;\n", i);
+
+    if (!imports.empty())
+      out += "\n";
+
+    gen_flat();
+
+    for (size_t b = 0; b < std::max<size_t>(conf.namespace_blocks, 1); b++) {
+      if (conf.namespace_depth)
+        gen_nest(0, "", b);
+    }
+
+    out += "fn main() -> int {\n";
+
+    if (conf.functions)
+      out += "  f0(1, \"main\");\n";
+
+    for (auto i : imports)
+      out += format("  mod%zu::f0(2, \"main\");\n", i);
+
+    out += "}\n";
+
+    return std::move(out);
+  }
+
+  std::string Synth::gen_module(size_t index, std::vector<size_t> const& imports) {
+    out.clear();
+
+    for (auto i : imports)
+      out += format("import mod%zu;\n", i);
+
+    if (!imports.empty())
+      out += "\n";
+
+    auto blocks = std::max<size_t>(conf.namespace_blocks, 1);
+
+    for (size_t b = 0; b < blocks; b++) {
+      out += format("namespace mod%zu {\n", index);
+
+      for (size_t i = b; i < conf.classes; i += blocks)
+        gen_class(format("K%zu", i), "");
+
+      for (size_t i = b; i < conf.enums; i += blocks)
+        gen_enum(format("E%zu", i));
+
+      for (size_t i = b; i < conf.functions; i += blocks) {
+        std::string callee;
+
+        if (i + 1 < conf.functions)
+          callee = format("f%zu", i + 1);
+        else if (!imports.empty())
+          callee = format("mod%zu::f0", imports[0]);
+
+        gen_function(format("f%zu", i), callee, conf.classes ? format("K%zu", i % conf.classes) : "",
+                     conf.enums ? format("E%zu", i % conf.enums) : "", i);
+      }
+
+      out += "}\n\n";
+    }
+
+    return std::move(out);
+  }
+
+  void Synth::gen_class(std::string const& name, std::string const& base) {
+    out += "class " + name + (base.empty() ? "" : " : " + base) + " {\n";
+    out += "  var x: int;\n";
+    out += "  var s: string;\n";
+    out += "  fn get(self, n: int) -> int { println(self.x + n); }\n";
+    out += "}\n\n";
+  }
+
+  void Synth::gen_enum(std::string const& name) {
+    out += "enum " + name + " { A, B(int), C(int, string), D(a: int, b: string) }\n\n";
+  }
+
+  //
+  // binary expression of int, nested "depth" times.
+  // one side of each operator is a leaf, so size is linear to depth.
+  std::string Synth::gen_expr(size_t depth, bool use_a) {
+    static char const* ops[] = {"+", "-", "*", "/", "&", "|", "^", "<<", ">>"};
+
+    auto leaf = [&] {
+      switch (rand(use_a ? 3 : 2)) {
+        case 0:
+          return std::string("n");
+        case 1:
+          return std::to_string(rand(9) + 1);
+      }
+      return std::string("a");
+    };
+
+    if (depth == 0)
+      return leaf();
+
+    std::string op = ops[rand(std::size(ops))];
+    auto sub = gen_expr(depth - 1, use_a);
+
+    // don't divide by variables.
+    if (op == "/")
+      return "(" + sub + " / " + std::to_string(rand(9) + 1) + ")";
+
+    if (rand(2))
+      return "(" + sub + " " + op + " " + leaf() + ")";
+
+    return "(" + leaf() + " " + op + " " + sub + ")";
+  }
+
+  void Synth::gen_function(std::string const& name, std::string const& callee,
+                           std::string const& klass, std::string const& enum_name, size_t index) {
+    out += "fn " + name + "(n: int, s: string) -> int {\n";
+    out += "  var a: int = " + gen_expr(conf.expr_depth, false) + ";\n";
+    out += "  var b = " + gen_expr(conf.expr_depth, true) + ";\n";
+
+    if (!klass.empty()) {
+      out += "  var k: " + klass + ";\n";
+      out += "  k.get(a);\n";
+    }
+
+    if (!enum_name.empty())
+      out += "  var e = " + enum_name + "::B(a);\n";
+
+    out += "  if a > 3 && b < 10 { var c = a + 1; println(c); } else { println(s); }\n";
+    out += format("  var v = [%zu, a, b];\n", index);
+    out += "  for x in v { println(x, \"" + name + "\"); }\n";
+
+    if (!callee.empty())
+      out += "  " + callee + "(a, s);\n";
+
+    out += "}\n\n";
+  }
+
+  void Synth::gen_flat() {
+    if (conf.classes)
+      gen_class("Base", "");
+
+    for (size_t i = 0; i < conf.classes; i++)
+      gen_class(format("K%zu", i), i % 2 ? "Base" : "");
+
+    for (size_t i = 0; i < conf.enums; i++)
+      gen_enum(format("E%zu", i));
+
+    for (size_t i = 0; i < conf.functions; i++) {
+      gen_function(format("f%zu", i), i + 1 < conf.functions ? format("f%zu", i + 1) : "",
+                   conf.classes ? format("K%zu", i % conf.classes) : "",
+                   conf.enums ? format("E%zu", i % conf.enums) : "", i);
+    }
+  }
+
+  //
+  // namespace nsN { ... namespace nsN+1 { ... } }
+  //   "outer" is the full name of parent namespace.
+  //   only items for the block are generated, so nests of all blocks
+  //   are merged into one.
+  void Synth::gen_nest(size_t level, std::string const& outer, size_t block) {
+    auto name = format("ns%zu", level);
+    auto full = outer.empty() ? name : outer + "::" + name;
+    auto blocks = std::max<size_t>(conf.namespace_blocks, 1);
+
+    out += "namespace " + name + " {\n";
+
+    for (size_t i = block; i < conf.classes; i += blocks)
+      gen_class(format("N%zu_%zu", level, i), "");
+
+    for (size_t i = block; i < conf.functions; i += blocks) {
+      // refer to items in outer level by full name.
+      auto callee = outer.empty() ? "" : format("%s::g%zu_%zu", outer.c_str(), level - 1, i);
+      auto klass = !conf.classes ? ""
+                   : outer.empty() ? format("N%zu_%zu", level, i % conf.classes)
+                                   : format("%s::N%zu_%zu", outer.c_str(), level - 1, i % conf.classes);
+
+      gen_function(format("g%zu_%zu", level, i), callee, klass, "", i);
+    }
+
+    if (level + 1 < conf.namespace_depth)
+      gen_nest(level + 1, full, block);
+
+    out += "}\n\n";
+  }
+
+} // namespace fire::bench
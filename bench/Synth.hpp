@@ -0,0 +1,78 @@
+#pragma once
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace fire::bench {
+
+  //
+  // Synth
+  //   generates valid Fire sources for benchmarks and stress tests.
+  //   same config gives same sources.
+  struct Synth {
+    struct Config {
+      size_t functions = 100;
+      size_t classes = 10;
+      size_t enums = 10;
+
+      // depth of nested namespaces.
+      // each level has "classes" classes and "functions" functions, and
+      // they refer to items of outer levels by full names.
+      size_t namespace_depth = 0;
+
+      // how many times each namespace is opened.
+      // items are split into the blocks, and merged again by the parser.
+      size_t namespace_blocks = 1;
+
+      // count of imported modules, and imports in each module.
+      // modules make a tree: main imports mod0..modN-1, mod0 imports next ones, ...
+      size_t modules = 0;
+      size_t import_fanout = 2;
+
+      // depth of nested binary expressions in each function.
+      size_t expr_depth = 2;
+
+      unsigned seed = 1;
+    };
+
+    struct File {
+      std::string name; // "main.fire", "mod0.fire", ...
+      std::string data;
+    };
+
+    Config conf;
+
+    Synth(Config conf) : conf(conf), rng(conf.seed) {}
+
+    // main module only. (imports are not generated)
+    std::string generate();
+
+    // main.fire and imported modules.
+    std::vector<File> generate_files();
+
+  private:
+    std::string out;
+    std::mt19937 rng;
+
+    size_t rand(size_t n) {
+      return rng() % n;
+    }
+
+    std::string gen_main(std::vector<size_t> const& imports);
+    std::string gen_module(size_t index, std::vector<size_t> const& imports);
+
+    std::vector<size_t> imports_of(long index) const;
+
+    void gen_class(std::string const& name, std::string const& base);
+    void gen_enum(std::string const& name);
+    void gen_function(std::string const& name, std::string const& callee, std::string const& klass,
+                      std::string const& enum_name, size_t index);
+
+    std::string gen_expr(size_t depth, bool use_a);
+
+    void gen_flat();
+    void gen_nest(size_t level, std::string const& outer, size_t block);
+  };
+
+} // namespace fire::bench
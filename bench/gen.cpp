@@ -0,0 +1,108 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include "Synth.hpp"
+
+//
+// fire_gen [options]
+//   generates a large valid Fire program.
+//
+//   --functions=N        functions in each module and namespace level (default 100)
+//   --classes=N          classes (default 10)
+//   --enums=N            enums (default 10)
+//   --namespace-depth=N  depth of nested namespaces (default 0)
+//   --namespace-blocks=N times each namespace is opened (default 1)
+//   --modules=N          imported modules (default 0)
+//   --fanout=N           imports in each module (default 2)
+//   --expr-depth=N       depth of expressions (default 2)
+//   --seed=N             seed of random expressions (default 1)
+//   --out=DIR            write main.fire and modules into DIR
+//                        (without this, main module is written to stdout)
+int main(int argc, char** argv) {
+  using fire::bench::Synth;
+
+  Synth::Config conf;
+  std::string out_dir;
+
+  struct {
+    char const* name;
+    size_t* value;
+  } const counts[] = {
+      {"functions=", &conf.functions},
+      {"classes=", &conf.classes},
+      {"enums=", &conf.enums},
+      {"namespace-depth=", &conf.namespace_depth},
+      {"namespace-blocks=", &conf.namespace_blocks},
+      {"modules=", &conf.modules},
+      {"fanout=", &conf.import_fanout},
+      {"expr-depth=", &conf.expr_depth},
+  };
+
+  for (int i = 1; i < argc; i++) {
+    char const* arg = argv[i];
+
+    if (std::strncmp(arg, "--", 2) != 0) {
+      std::fprintf(stderr, "unknown argument: %s\n", arg);
+      return -1;
+    }
+
+    arg += 2;
+
+    bool found = false;
+
+    for (auto const& [name, value] : counts) {
+      if (auto len = std::strlen(name); std::strncmp(arg, name, len) == 0) {
+        *value = std::strtoull(arg + len, nullptr, 10);
+        found = true;
+        break;
+      }
+    }
+
+    if (found)
+      continue;
+
+    if (std::strncmp(arg, "seed=", 5) == 0)
+      conf.seed = std::strtoul(arg + 5, nullptr, 10);
+    else if (std::strncmp(arg, "out=", 4) == 0)
+      out_dir = arg + 4;
+    else {
+      std::fprintf(stderr, "unknown option: %s\n", arg);
+      return -1;
+    }
+  }
+
+  if (out_dir.empty()) {
+    if (conf.modules) {
+      std::fprintf(stderr, "--modules needs --out=DIR\n");
+      return -1;
+    }
+
+    std::fputs(Synth(conf).generate().c_str(), stdout);
+    return 0;
+  }
+
+  std::filesystem::create_directories(out_dir);
+
+  size_t total = 0;
+
+  for (auto const& file : Synth(conf).generate_files()) {
+    auto path = out_dir + "/" + file.name;
+    auto ofs = std::ofstream(path);
+
+    if (ofs.fail()) {
+      std::fprintf(stderr, "cannot open file: %s\n", path.c_str());
+      return 1;
+    }
+
+    ofs << file.data;
+    total += file.data.length();
+  }
+
+  std::fprintf(stderr, "generated %zu modules, %zu bytes into %s\n", conf.modules + 1, total,
+               out_dir.c_str());
+
+  return 0;
+}
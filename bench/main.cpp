@@ -0,0 +1,60 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "Bench.hpp"
+
+//
+// fire_bench [options]
+//   --filter=STR     run only benchmarks whose name contains STR
+//   --json=FILE      write results into FILE
+//   --warmup=N       runs before measuring (default 2)
+//   --samples=N      minimum samples (default 10)
+//   --max-samples=N  maximum samples (default 200)
+//   --min-time=MS    minimum total time of samples (default 1000)
+//   --list           print names of benchmarks
+int main(int argc, char** argv) {
+  using namespace fire::bench;
+
+  Runner R;
+
+  for (int i = 1; i < argc; i++) {
+    char const* arg = argv[i];
+
+    if (std::strncmp(arg, "--filter=", 9) == 0)
+      R.opts.filter = arg + 9;
+    else if (std::strncmp(arg, "--json=", 7) == 0)
+      R.opts.json_path = arg + 7;
+    else if (std::strncmp(arg, "--warmup=", 9) == 0)
+      R.opts.warmup = std::atoi(arg + 9);
+    else if (std::strncmp(arg, "--samples=", 10) == 0)
+      R.opts.min_samples = std::max(2, std::atoi(arg + 10));
+    else if (std::strncmp(arg, "--max-samples=", 14) == 0)
+      R.opts.max_samples = std::max(2, std::atoi(arg + 14));
+    else if (std::strncmp(arg, "--min-time=", 11) == 0)
+      R.opts.min_time_ms = std::atof(arg + 11);
+    else if (std::strcmp(arg, "--list") == 0)
+      R.opts.list = true;
+    else {
+      std::fprintf(stderr, "unknown option: %s\n", arg);
+      return -1;
+    }
+  }
+
+  R.opts.max_samples = std::max(R.opts.max_samples, R.opts.min_samples);
+
+#ifndef __OPTIMIZE__
+  std::fprintf(stderr, "warning: fire_bench is built without optimization. "
+                       "(configure with -DCMAKE_BUILD_TYPE=Release)\n");
+#endif
+
+  add_frontend_cases(R);
+  add_lsp_cases(R);
+  add_parser_pass_cases(R);
+  add_runtime_cases(R);
+  add_strconv_cases(R);
+  add_string_cases(R);
+
+  return R.run();
+}
@@ -2,12 +2,29 @@
 
 #include <vector>
 #include <cstdint>
+#include <initializer_list>
+#include <string_view>
+#include <unordered_map>
 
 #include "Object.hpp"
 
 namespace fire {
+  //
+  // BuiltinFunc
+  //   args are slots of arguments in the register file of the VM (self is
+  //   the first one of a method), and the result is written into the slot
+  //   of destination. a call allocates nothing by itself.
+  //
+  //   builtins with fixed arity have fast entry points too, which take the
+  //   arguments directly. (VM calls them when the arity matches)
+  //
+  //   results are shared objects (ObjBool::get, ObjInt::get) when possible.
+  //   (their values are const)
   struct BuiltinFunc {
-    using FuncPointer = Object* (*)(std::vector<Object*>&);
+    using FuncPointer = void (*)(Object* const* args, size_t argc, Object*& result);
+
+    using FastPointer1 = Object* (*)(Object* a);
+    using FastPointer2 = Object* (*)(Object* a, Object* b);
 
     char const* name = nullptr;
     bool is_var_args = false;
@@ -16,24 +33,65 @@ namespace fire {
     TypeInfo result_type = {};
     bool returning_self = false;
     FuncPointer impl = nullptr;
+
+    FastPointer1 fast1 = nullptr;
+    FastPointer2 fast2 = nullptr;
   };
 
-  extern BuiltinFunc blt_print;
-  extern BuiltinFunc blt_println;
+  //
+  // BuiltinRegistry
+  //   builtin functions and methods, keyed by (self type, name).
+  //   functions have TypeKind::None as self type.
+  //
+  //   families of builtins (string, vector, io, ...) are added as modules
+  //   at startup, before Sema. after that it's only read, from any thread.
+  class BuiltinRegistry {
+  public:
+    // core builtins are added when it's created.
+    static BuiltinRegistry& get_instance();
 
-  extern BuiltinFunc bltm_string_starts;
-  extern BuiltinFunc bltm_vector_append;
+    // false if a builtin of same key is already added. (not replaced)
+    bool add(BuiltinFunc const* func);
 
-  static constexpr BuiltinFunc const* builtin_func_table[] = {
-      &blt_print,
-      &blt_println,
-  };
+    void add_module(char const* name, std::initializer_list<BuiltinFunc const*> funcs);
+
+    BuiltinFunc const* find_func(std::string_view name) const {
+      return find(TypeKind::None, name);
+    }
+
+    BuiltinFunc const* find_method(TypeKind self, std::string_view name) const {
+      return find(self, name);
+    }
+
+    std::vector<char const*> const& get_module_names() const {
+      return modules;
+    }
 
-  static constexpr BuiltinFunc const* builtin_method_table[] = {
-    // string::starts(self, string) -> bool
-    &bltm_string_starts,
+  private:
+    struct Key {
+      TypeKind self;
+      std::string_view name;
 
-    // vector::append(self, value)
-    &bltm_vector_append,
+      bool operator==(Key const& k) const {
+        return self == k.self && name == k.name;
+      }
+    };
+
+    struct KeyHash {
+      size_t operator()(Key const& k) const {
+        return std::hash<std::string_view>()(k.name) * 31 + static_cast<size_t>(k.self);
+      }
+    };
+
+    std::unordered_map<Key, BuiltinFunc const*, KeyHash> table;
+    std::vector<char const*> modules;
+
+    BuiltinRegistry();
+
+    BuiltinFunc const* find(TypeKind self, std::string_view name) const {
+      auto it = table.find({self, name});
+      return it == table.end() ? nullptr : it->second;
+    }
   };
+
 } // namespace fire
\ No newline at end of file
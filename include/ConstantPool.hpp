@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace fire {
+  struct Object;
+
+  //
+  // ConstantPool
+  //   literals of a module. (imported files share the pool of the importer)
+  //   same values are added once, and index is the index in constant section.
+  //   true, false and none are shared objects.
+  //
+  //   objects in the pool are shared by all uses, so they must not be changed.
+  class ConstantPool {
+  public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    size_t add_none();
+    size_t add_bool(bool value);
+    size_t add_int(std::int64_t value);
+    size_t add_float(double value);
+    size_t add_char(char16_t value);
+    size_t add_string(std::u16string_view value);
+
+    Object* get(size_t index) const {
+      return constants[index];
+    }
+
+    size_t size() const {
+      return constants.size();
+    }
+
+    std::vector<Object*> const& get_constants() const {
+      return constants;
+    }
+
+  private:
+    std::vector<Object*> constants;
+
+    size_t none_index = npos;
+    size_t bool_index[2] = {npos, npos};
+
+    std::unordered_map<std::int64_t, size_t> ints;
+    std::unordered_map<std::uint64_t, size_t> floats; // by bits (keeps -0.0 and NaNs)
+    std::unordered_map<char16_t, size_t> chars;
+
+    // key is a view of data of ObjString in the pool.
+    std::unordered_map<std::u16string_view, size_t> strings;
+
+    size_t append(Object* obj);
+  };
+
+} // namespace fire
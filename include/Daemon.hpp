@@ -0,0 +1,62 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace fire {
+
+  class Program;
+
+  //
+  // Daemon
+  //   "fire --daemon": a long-lived compiler which keeps parsed and analyzed
+  //   files of programs in memory. (see Program)
+  //
+  //   "fire --client ..." sends cwd and arguments on a unix domain socket,
+  //   with its stdin/stdout/stderr. (SCM_RIGHTS) so output of the compiler is
+  //   written directly to the client, and it exits with the code of the run.
+  //
+  //   requests are handled one by one.
+  class Daemon {
+  public:
+    // exit code: run it in the client instead. (options, or no daemon)
+    static constexpr int Fallback = 0x7fff'ffff;
+
+    explicit Daemon(std::string const& socket_path);
+
+    // until killed. returns exit code if the socket can't be used.
+    int run();
+
+    // fire-<uid>/daemon.sock in $XDG_RUNTIME_DIR, or in /tmp.
+    // the folder is created with mode 0700, and used only if it's private.
+    static std::string get_default_path();
+
+    // send the run to the daemon. returns exit code, or Fallback.
+    static int forward(std::string const& socket_path, std::vector<std::string> const& args);
+
+  private:
+    // programs kept in memory at most.
+    static constexpr size_t MaxPrograms = 32;
+
+    struct Entry {
+      Program* program = nullptr;
+      size_t last_used = 0;
+    };
+
+    std::string socket_path;
+
+    std::unordered_map<std::string, Entry> programs; // absolute path -> program
+    size_t requests = 0;
+
+    int saved_fds[3] = {-1, -1, -1}; // stdin/stdout/stderr of the daemon
+
+    void serve(int conn);
+
+    // compile inputs. same exit codes as one-shot run.
+    int compile(std::vector<std::string> const& args);
+
+    Program* get_program(std::string const& path);
+  };
+
+} // namespace fire
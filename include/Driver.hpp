@@ -17,6 +17,9 @@ namespace fire {
 
     std::string get_first_cwd() const { return cwd; }
 
+    // cwd of the client. (daemon)
+    void set_first_cwd(std::string const& path) { cwd = path; }
+
     int main(int argc, char** argv);
   };
 } // namespace fire
\ No newline at end of file
@@ -34,6 +34,14 @@ namespace fire {
       invalid_token(Token const& t) : e(t, "invalid token") {}
     };
 
+    struct invalid_number_literal : e {
+      invalid_number_literal(Token const& t, std::string const& msg) : e(t, msg) {}
+    };
+
+    struct invalid_string_literal : e {
+      invalid_string_literal(Token const& t, std::string const& msg) : e(t, msg) {}
+    };
+
     struct invalid_character_literal : e {
       invalid_character_literal(Token const& t) : e(t, "invalid character literal") {}
     };
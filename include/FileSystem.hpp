@@ -81,6 +81,9 @@ namespace fire {
     static std::string GetBaseName(std::string const& path);
     static std::string GetFolderOfFile(std::string const& path);
 
+    // "a/b/" --> "a/b" (root is kept)
+    static std::string StripTrailingSlash(std::string path);
+
     static bool Exists(std::string const& path);
     static bool IsDirectory(std::string const& path);
     static bool IsFile(std::string const& path);
@@ -10,7 +10,11 @@
   - for, while, ...     --> loop
   - if, match, switch   --> if
 
+  ** for は IRForeach として残す (要素の取り出しは VM の命令で行う) **
+
   ** try-catch はまだ残す **
+     - return, break, continue の直前には finally を展開する
+     - 通常の出口と例外の出口は VM::ExceptionTable で扱う
 
 */
 
@@ -25,6 +29,7 @@ namespace fire::IR::High {
     Function,
     Struct,
     Enum,
+    Module,
   };
 
   enum class StmtKind {
@@ -33,6 +38,7 @@ namespace fire::IR::High {
     If,
     While,
     Loop,
+    Foreach,
     Break,
     Continue,
     Return,
@@ -53,7 +59,13 @@ namespace fire::IR::High {
     Node* expr = nullptr;
     TypeInfo type;
 
+    // variable created by lowering. (expr is null)
+    std::string temp_name;
+
     IRExpr(Node* expr, TypeInfo type) : Base(Kind::Expr), expr(expr), type(std::move(type)) {}
+
+    IRExpr(std::string const& temp_name, TypeInfo type)
+        : Base(Kind::Expr), type(std::move(type)), temp_name(temp_name) {}
   };
 
   struct IRStmt : Base {
@@ -92,6 +104,14 @@ namespace fire::IR::High {
     IRLoop(IRScope* body) : IRStmt(StmtKind::Loop), body(body) {}
   };
 
+  struct IRForeach : IRStmt {
+    std::string iter_name;
+    IRExpr* iterable = nullptr;
+    IRScope* body = nullptr;
+    IRForeach(std::string const& iter_name, IRExpr* iterable, IRScope* body)
+        : IRStmt(StmtKind::Foreach), iter_name(iter_name), iterable(iterable), body(body) {}
+  };
+
   struct IRBreak : IRStmt {
     IRBreak() : IRStmt(StmtKind::Break) {}
   };
@@ -147,6 +167,15 @@ namespace fire::IR::High {
     IREnum(std::string const& name, std::vector<std::string> enumerators)
         : Base(Kind::Enum), name(name), enumerators(std::move(enumerators)) {}
   };
+
+  struct IRModule : Base {
+    std::vector<Base*> items;
+
+    // constant section. (NdValue::const_index is index of this)
+    std::vector<Object*> constants;
+
+    IRModule() : Base(Kind::Module) {}
+  };
 } // namespace fire::IR::High
 
 namespace fire::IR::Middle {
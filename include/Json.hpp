@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace fire {
+
+  //
+  // Json
+  //   value of JSON. (messages of language server)
+  //   members of object are kept in order of insertion.
+  class Json {
+  public:
+    enum class Kind {
+      Null,
+      Bool,
+      Number,
+      String,
+      Array,
+      Object,
+    };
+
+    Json() = default;
+    Json(std::nullptr_t) {}
+    Json(bool b) : kind(Kind::Bool), b(b) {}
+    Json(int n) : kind(Kind::Number), num(n) {}
+    Json(std::int64_t n) : kind(Kind::Number), num((double)n) {}
+    Json(size_t n) : kind(Kind::Number), num((double)n) {}
+    Json(double n) : kind(Kind::Number), num(n) {}
+    Json(char const* s) : kind(Kind::String), str(s) {}
+    Json(std::string s) : kind(Kind::String), str(std::move(s)) {}
+    Json(std::string_view s) : kind(Kind::String), str(s) {}
+
+    static Json array() {
+      Json j;
+      j.kind = Kind::Array;
+      return j;
+    }
+
+    static Json object() {
+      Json j;
+      j.kind = Kind::Object;
+      return j;
+    }
+
+    Kind get_kind() const { return kind; }
+
+    bool is(Kind k) const { return kind == k; }
+
+    bool is_null() const { return kind == Kind::Null; }
+
+    // default values if the kind is different.
+    bool as_bool() const { return kind == Kind::Bool && b; }
+    double as_number() const { return kind == Kind::Number ? num : 0; }
+    std::int64_t as_int() const { return (std::int64_t)as_number(); }
+    std::string const& as_string() const;
+
+    // count of elements or members.
+    size_t size() const;
+
+    // member of object. (null if not found)
+    Json const& operator[](std::string_view key) const;
+
+    // element of array. (null if out of range)
+    Json const& operator[](size_t index) const;
+
+    // set member of object. returns this.
+    Json& set(std::string_view key, Json value);
+
+    // append to array. returns this.
+    Json& push(Json value);
+
+    std::string dump() const;
+    void dump(std::string& out) const;
+
+    // false if the text is not a JSON.
+    static bool parse(std::string_view text, Json& out);
+
+  private:
+    Kind kind = Kind::Null;
+
+    bool b = false;
+    double num = 0;
+    std::string str;
+
+    std::vector<Json> elems;
+    std::vector<std::pair<std::string, Json>> members;
+  };
+
+} // namespace fire
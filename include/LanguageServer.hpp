@@ -0,0 +1,205 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Json.hpp"
+#include "Output.hpp"
+#include "SourceFile.hpp"
+
+namespace fire {
+
+  struct Token;
+  struct Node;
+  struct NdModule;
+  class ConstantPool;
+  class Sema;
+
+  namespace err {
+    struct e;
+  }
+
+} // namespace fire
+
+namespace fire::LSP {
+
+  // position in text of LSP. (0-based, character is in UTF-16 units)
+  struct Position {
+    size_t line = 0;
+    size_t character = 0;
+  };
+
+  struct Diagnostic {
+    size_t begin = 0; // offsets in text
+    size_t end = 0;
+    std::string message;
+    bool is_warn = false;
+  };
+
+  // place of a declaration.
+  struct Location {
+    std::string path;
+    Position begin;
+    Position end;
+  };
+
+  //
+  // Document
+  //   an open file, with its tokens, items and Sema state kept resident.
+  //
+  //   on update, only items around the edited range are re-lexed and re-parsed;
+  //   other items are kept with their positions shifted. then Sema checks
+  //   again the changed items and their dependents. (see Sema::reanalyze)
+  //
+  //   nodes taken over keep tokens of the version they were parsed from, so
+  //   positions are mapped between versions through the tokens of each item.
+  class Document {
+  public:
+    Document(std::string path, std::string text);
+
+    std::string const& get_path() const {
+      return path;
+    }
+
+    std::string const& get_text() const {
+      return text;
+    }
+
+    // replace [begin, end) of text. (offsets)
+    void edit(size_t begin, size_t end, std::string_view str);
+
+    // analyze edited text.
+    void update();
+
+    size_t to_offset(Position pos) const;
+    Position to_position(size_t offset) const;
+
+    std::vector<Diagnostic> const& get_diagnostics() const {
+      return diagnostics;
+    }
+
+    // type or declaration at offset, as markdown. (empty if nothing)
+    std::string get_hover(size_t offset, size_t& begin, size_t& end);
+
+    bool get_definition(size_t offset, Location& loc);
+
+    // count of items re-parsed by last update.
+    size_t get_reparsed_count() const {
+      return reparsed_count;
+    }
+
+  private:
+    struct Item {
+      Node* node = nullptr; // null if the text has an error
+
+      // first and last token in the latest lexing of the range.
+      // (same tokens as the node, but maybe of a newer version)
+      Token const* first = nullptr;
+      Token const* last = nullptr;
+
+      // range in text.
+      size_t begin = 0;
+      size_t end = 0;
+    };
+
+    std::string path;
+    std::string text;
+    std::vector<size_t> line_starts;
+
+    // files of this document. (versions and imported files)
+    SourceFile::Registry registry;
+
+    SourceFile* file = nullptr;          // analyzed version
+    std::vector<SourceFile*> versions;   // older ones used by items
+
+    std::vector<Item> items; // in order of text
+    size_t header_end = 0;   // end of imports
+
+    std::vector<Node*> imported; // items of imported files
+
+    // re-parse entire file next time.
+    // (namespaces split into blocks are merged into a node)
+    bool need_full = true;
+
+    bool parse_failed = false;
+
+    ConstantPool* pool = nullptr;
+    Sema* sema = nullptr;
+    NdModule* mod = nullptr;
+
+    std::vector<Diagnostic> diagnostics;
+
+    size_t reparsed_count = 0;
+
+    size_t get_line(size_t offset) const;
+
+    void reparse_full();
+
+    // false if changes can't be re-parsed partially.
+    bool reparse_changed(SourceFile const* prev);
+
+    Node* reparse_item(SourceFile const* src, size_t begin, size_t end, size_t line);
+
+    void analyze();
+
+    void release_versions();
+
+    void add_diagnostic(err::e const& e);
+
+    Item const* find_item(size_t offset) const;
+
+    // the token in the item's node, at offset in text.
+    Token const* find_token(Item const& item, size_t offset) const;
+
+    // offset in text of a position in some version. (or npos)
+    size_t map_pos(SourceFile const* src, size_t pos) const;
+  };
+
+  //
+  // Server
+  //   language server on stdin and stdout. ("fire --lsp")
+  //   supports diagnostics, hover and go to definition.
+  class Server {
+  public:
+    explicit Server(int out_fd);
+
+    // until "exit" notification. returns exit code.
+    int run();
+
+  private:
+    Output out;
+
+    std::unordered_map<std::string, Document*> documents; // uri -> document
+
+    bool is_shutdown = false;
+
+    bool read_message(std::string& body);
+
+    void send(Json const& msg);
+
+    void send_result(Json const& id, Json result);
+    void send_error(Json const& id, int code, std::string const& msg);
+
+    // returns false on "exit".
+    bool handle(Json const& msg);
+
+    Json on_initialize(Json const& params);
+
+    void on_did_open(Json const& params);
+    void on_did_change(Json const& params);
+    void on_did_close(Json const& params);
+
+    Json on_hover(Json const& params);
+    Json on_definition(Json const& params);
+
+    void publish_diagnostics(std::string const& uri, Document& doc);
+
+    Document* get_document(Json const& params);
+  };
+
+  std::string uri_to_path(std::string_view uri);
+  std::string path_to_uri(std::string_view path);
+
+} // namespace fire::LSP
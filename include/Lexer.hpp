@@ -10,21 +10,52 @@ namespace fire {
   class Lexer {
     SourceFile const* _source;
     size_t _pos = 0;
+    size_t const _begin = 0;
     size_t const _len;
 
+    // line number at _begin.
+    size_t const _line = 1;
+
+    // a comment reached the end without being closed.
+    bool _open_comment = false;
+
+    // buffer to decode escapes. (reused)
+    std::string _buf;
+
   public:
     Lexer(SourceFile const* source) : _source(source), _pos(0), _len(source->length) {}
 
+    // lex only [begin, end) of the source. (re-lexing an edited part)
+    // begin must be a boundary of tokens, and line is the line number at there.
+    Lexer(SourceFile const* source, size_t begin, size_t end, size_t line)
+        : _source(source), _pos(begin), _begin(begin), _len(end), _line(line) {}
+
     Token* lex();
 
+    // true if lexing ended with a space, outside of comments.
+    // if not, a token or a comment might continue after the range.
+    bool is_clean_end() const {
+      return !_open_comment && (_len == _begin || isspace(get_char(_len - 1)));
+    }
+
     Token* tokenize(char c, Token* prev);
 
   private:
+    void lex_number(Token* tok);
+    void lex_string(Token* tok, char quote);
+
+    // set line and column of the token before throwing an error.
+    // (they are set for all tokens at end of lex())
+    void locate(Token* tok);
+
+    // column at _begin.
+    size_t get_first_column() const;
+
     bool is_end() { return _pos >= _len; }
 
     char peek() { return (*_source)[_pos]; }
 
-    char get_char(size_t pos) { return (*_source)[pos]; }
+    char get_char(size_t pos) const { return (*_source)[pos]; }
 
     char const* getptr() { return _source->data.data() + _pos; }
 
@@ -44,13 +75,37 @@ namespace fire {
       if (consume("//")) {
         while (!is_end() && peek() != '\n')
           _pos++;
+
+        _open_comment = is_end();
       }
     }
 
     void pass_block_comment() {
       if (consume("/*")) {
-        while (!is_end() && !consume("*/"))
+        _open_comment = true;
+
+        while (!is_end()) {
+          if (consume("*/")) {
+            _open_comment = false;
+            break;
+          }
+
           _pos++;
+        }
+      }
+    }
+
+    // spaces and comments before a token.
+    void pass_space_and_comments() {
+      for (;;) {
+        pass_space();
+
+        if (match("//"))
+          pass_line_comment();
+        else if (match("/*"))
+          pass_block_comment();
+        else
+          break;
       }
     }
   };
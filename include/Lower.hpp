@@ -4,8 +4,39 @@
 
 namespace fire {
   class HighIRCreator {
+    struct Finally {
+      NdScope* block = nullptr;
+      size_t loop_base = 0; // loop_finally_base at the try
+    };
+
+    // finally blocks of the try statements we are in. (outer first)
+    std::vector<Finally> finally_stack;
+
+    // size of finally_stack at the entry of the innermost loop.
+    size_t loop_finally_base = 0;
+
+    size_t tmp_var_count = 0;
+
   public:
     static IR::High::Base* create_full_hir(Node* node);
+
+    void create_items(IR::High::IRModule* mod, std::vector<Node*>& items,
+                      std::string const& prefix);
+
+    IR::High::IRFunction* create_function(NdFunction* node, std::string const& name);
+    IR::High::IRStruct* create_struct(NdClass* node, std::string const& name);
+
+    IR::High::IRScope* create_scope(NdScope* node);
+    IR::High::IRStmt* create_stmt(Node* node);
+    IR::High::IRExpr* create_expr(Node* node);
+
+  private:
+    // run finally blocks (innermost first) down to `base`, and then `exit`.
+    // each exit path has own copy of the blocks.
+    IR::High::IRStmt* with_finally(IR::High::IRStmt* exit, size_t base);
+
+    // a finally block, lowered outside of its own try.
+    IR::High::IRScope* create_finally(size_t index);
   };
 
   class MiddleIRCreator {
@@ -22,4 +53,4 @@ namespace fire {
   public:
     static IR::Low::LIR* lower_full(Node* node);
   };
-} // namespace fire
\ No newline at end of file
+} // namespace fire
@@ -7,11 +7,17 @@
 #include "Lexer.hpp"
 #include "Token.hpp"
 #include "Object.hpp"
+#include "ConstantPool.hpp"
 
 namespace fire {
 
   struct BuiltinFunc;
 
+  namespace VM {
+    struct InlineCache;
+    struct ClassLayout;
+  }
+
   enum class NodeKind {
     Value,
 
@@ -110,6 +116,7 @@ namespace fire {
   };
 
   struct NdFunction;
+  struct NdClass;
 
   //
   // in Sema
@@ -128,6 +135,10 @@ namespace fire {
     TypeInfo ty = {};
     bool ty_evaluated = false;
 
+    // last token of the item of module or namespace.
+    // (used to get fingerprint for incremental analysis)
+    Token* end_token = nullptr;
+
     template <typename T>
     T* as() {
       return static_cast<T*>(this);
@@ -165,9 +176,15 @@ namespace fire {
 
   struct NdValue : Node {
     Object* obj = nullptr;
+    size_t const_index = ConstantPool::npos; // index in constant pool of module
+
     NdValue(Token& t) : Node(NodeKind::Value, t) {
     }
-    NdValue(Token& t, Object* obj) : Node(NodeKind::Value, t), obj(obj) {
+    NdValue(Token& t, Object* obj, size_t const_index = ConstantPool::npos)
+        : Node(NodeKind::Value, t), obj(obj), const_index(const_index) {
+    }
+    NdValue(Token& t, ConstantPool const* pool, size_t const_index)
+        : Node(NodeKind::Value, t), obj(pool->get(const_index)), const_index(const_index) {
     }
   };
 
@@ -253,8 +270,17 @@ namespace fire {
     NdFunction* func_nd = nullptr;
     BuiltinFunc const* builtin = nullptr;
 
+    // method call on class instance:
+    //   is_virtual = false --> call func_nd directly (devirtualized by Sema)
+    //   is_virtual = true  --> dispatch by receiver's class through inline_cache
+    bool is_virtual = false;
+    VM::InlineCache* inline_cache = nullptr;
+
+    // constructor call "A(...)": func_nd is A::new (or null if not defined)
+    NdClass* construct_class = nullptr;
+
     bool is_builtin() const {
-      return !func_nd;
+      return !func_nd && !construct_class;
     }
 
     NdCallFunc(Node* callee, Token& tok) : Node(NodeKind::CallFunc, tok), callee(callee) {
@@ -323,6 +349,10 @@ namespace fire {
     NodeKind opkind;
     Node* lhs = nullptr;
     Node* rhs = nullptr;
+
+    // "s += x" of string in a loop: candidate for StringBuilder. (set by Sema)
+    bool use_builder = false;
+
     NdAssignWithOp(NodeKind opkind, Token& op, Node* l, Node* r)
         : Node(NodeKind::AssignWithOp, op), opkind(opkind), lhs(l), rhs(r) {
     }
@@ -331,6 +361,10 @@ namespace fire {
   struct NdExpr : Node {
     Node* lhs;
     Node* rhs;
+
+    // "s = s + x" of string in a loop: candidate for StringBuilder. (set by Sema)
+    bool use_builder = false;
+
     NdExpr(NodeKind k, Token& op, Node* l, Node* r) : Node(k, op), lhs(l), rhs(r) {
     }
   };
@@ -347,7 +381,7 @@ namespace fire {
 
     bool is_pub = false; // when field
 
-    int index = 0;
+    int index = 0; // when field: slot in the instance (including base class fields)
 
     Symbol* symbol_ptr = nullptr;
 
@@ -418,6 +452,10 @@ namespace fire {
   struct NdTemplatableBase : Node {
     std::vector<NdSymbol*> parameter_defs; // <T, U, ...>
 
+    // if this is a specialized copy of template (see Sema::instantiate)
+    NdTemplatableBase* template_origin = nullptr;
+    std::vector<TypeInfo> template_args;
+
     int count() const {
       return (int)parameter_defs.size();
     }
@@ -450,6 +488,8 @@ namespace fire {
     bool take_self = false; //
     bool is_pub = false;    // when method
 
+    int vtable_index = -1; // when method
+
     NdFunction(Token& t, Token& name) : NdTemplatableBase(NodeKind::Function, t), name(name) {
     }
   };
@@ -495,6 +535,8 @@ namespace fire {
     NdFunction* m_new = nullptr;
     NdFunction* m_delete = nullptr;
 
+    VM::ClassLayout* layout = nullptr; // see VM::ClassLayout::of()
+
     NdClass(Token& tok, Token& name) : NdTemplatableBase(NodeKind::Class, tok), name(name) {
     }
   };
@@ -513,6 +555,9 @@ namespace fire {
 
     NdFunction* main_fn = nullptr;
 
+    // literals of this module and imported files.
+    ConstantPool* constants = nullptr;
+
     NdModule(Token& tok) : Node(NodeKind::Module, tok) {
     }
   };
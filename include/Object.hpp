@@ -6,6 +6,10 @@
 
 namespace fire {
 
+  namespace VM {
+    struct ClassLayout;
+  }
+
   struct ObjNone;
 
   struct Object {
@@ -39,10 +43,18 @@ namespace fire {
     ObjNone() : Object(TypeKind::None) {}
   };
 
+  // ints and bools are immutable, since ObjInt::get and ObjBool::get share them.
+  // (an operation makes a new object)
   struct ObjInt : Object {
-    std::int64_t val;
+    std::int64_t const val;
     Object* clone() const override { return new ObjInt(val); }
     ObjInt(std::int64_t v) : Object(TypeKind::Int), val(v) {}
+
+    // shared objects in [SmallMin, SmallMax], or new one.
+    static constexpr std::int64_t SmallMin = -128;
+    static constexpr std::int64_t SmallMax = 1023;
+
+    static ObjInt* get(std::int64_t v);
   };
 
   struct ObjFloat : Object {
@@ -52,9 +64,12 @@ namespace fire {
   };
 
   struct ObjBool : Object {
-    bool val;
+    bool const val;
     Object* clone() const override { return new ObjBool(val); }
     ObjBool(bool v) : Object(TypeKind::Bool), val(v) {}
+
+    // shared objects of true and false.
+    static ObjBool* get(bool v);
   };
 
   struct ObjChar : Object {
@@ -68,6 +83,9 @@ namespace fire {
 
     ObjString& append(ObjChar*);
     ObjString& append(ObjString*);
+
+    // new string of "a + b". (b is string or char)
+    static ObjString* concat(ObjString const* a, Object const* b);
     
     Object* clone() const override { return new ObjString(data); }
 
@@ -93,4 +111,28 @@ namespace fire {
     }
   };
 
-} // namespace fire
\ No newline at end of file
+  //
+  // ObjInstance
+  //   instance of class.
+  //   slots of fields are placed right after this object, so an instance is
+  //   allocated at once and a field is loaded from a constant offset.
+  struct ObjInstance : Object {
+    VM::ClassLayout const* layout;
+    size_t field_count;
+
+    Object** fields() { return reinterpret_cast<Object**>(this + 1); }
+    Object* const* fields() const { return reinterpret_cast<Object* const*>(this + 1); }
+
+    Object*& get_field(size_t offset) { return fields()[offset]; }
+
+    Object* clone() const override;
+
+    static ObjInstance* create(VM::ClassLayout const* layout);
+
+    static void operator delete(void* p) { ::operator delete(p); }
+
+  private:
+    ObjInstance(VM::ClassLayout const* layout, size_t field_count);
+  };
+
+} // namespace fire
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+namespace fire {
+
+  struct Object;
+
+  //
+  // Output
+  //   buffered output of running Fire programs. (print, println)
+  //   values are formatted into the buffer directly, and written to the
+  //   file descriptor when the buffer is full or flushed.
+  //
+  //   stdout is flushed at exit and before reading input. if it is a
+  //   terminal, it is flushed at end of each line too.
+  class Output {
+  public:
+    static constexpr size_t BufferSize = 64 * 1024;
+
+    explicit Output(int fd, bool line_buffered = false);
+
+    ~Output();
+
+    Output(Output const&) = delete;
+    Output& operator=(Output const&) = delete;
+
+    static Output& get_stdout();
+
+    // call before reading from stdin. (prompts must be visible)
+    static void before_read();
+
+    void write(std::string_view str);
+    void write(char c);
+    void write_utf16(char16_t const* str, size_t len);
+
+    void write_int(std::int64_t val);
+    void write_float(double val);
+
+    // same text as Object::to_string.
+    void write_object(Object const* obj);
+
+    // end of line. (flushed if line buffered)
+    void newline();
+
+    bool flush();
+
+    // bytes written since created. (including bytes in the buffer)
+    size_t get_total() const {
+      return failed ? total : total + used;
+    }
+
+    // a write has failed. (later output is dropped)
+    bool has_failed() const {
+      return failed;
+    }
+
+  private:
+    int fd;
+    bool line_buffered;
+
+    std::unique_ptr<char[]> buf;
+    size_t used = 0;
+    size_t total = 0;
+
+    bool failed = false;
+
+    // makes room for n bytes. (n <= BufferSize)
+    char* reserve(size_t n) {
+      if (BufferSize - used < n)
+        flush();
+
+      return buf.get() + used;
+    }
+
+    static void finish();
+  };
+
+} // namespace fire
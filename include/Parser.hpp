@@ -10,9 +10,15 @@ namespace fire {
 
     Token* cur;
 
+    // literals are added here. (shared with imported files)
+    ConstantPool* pool;
+
+    // buffer to convert string literals. (reused)
+    std::u16string strbuf;
+
   public:
-    Parser(SourceFile& source, Token* _tok)
-      : source(source), cur(_tok)
+    Parser(SourceFile& source, Token* _tok, ConstantPool* pool = nullptr)
+      : source(source), cur(_tok), pool(pool ? pool : new ConstantPool())
     {
     }
 
@@ -59,15 +65,20 @@ namespace fire {
     NdNamespace* ps_namespace();
 
     Node* ps_mod_item();
-    NdModule* ps_mod();
+    // items of imported files are added before own items, unless with_imports
+    // is false. (Watcher keeps items of each file)
+    NdModule* ps_mod(bool with_imports = true);
+
+    // items until the end of tokens. (without imports)
+    std::vector<Node*> ps_items();
 
     void ps_do_import(Token* import_token, std::string path);
 
     void ps_import();
 
-    void merge_namespaces(std::vector<Node*>& items);
+    static void merge_namespaces(std::vector<Node*>& items);
 
-    void reorder_items(std::vector<Node*>& items);
+    static void reorder_items(std::vector<Node*>& items);
 
     NdModule* parse();
 
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <csignal>
+#include <ctime>
+#include <memory>
+#include <string>
+
+#include "VM.hpp"
+
+namespace fire::VM {
+
+  //
+  // Profiler
+  //   sampling profiler of running Fire programs.
+  //   SIGPROF is sent to the VM thread by a timer of its cpu time, and
+  //   the handler copies the frame stack of the Context into preallocated buffers.
+  //
+  //   output is collapsed stacks for flamegraphs:
+  //     main (a.fire:10);f (a.fire:3) 42
+  //
+  //   enabled by "--profile=<file>", sampling while the driver runs the program.
+  class Profiler {
+  public:
+    static constexpr size_t MaxDepth = 128;
+    static constexpr int DefaultHz = 997;
+
+    static Profiler& get_instance();
+
+    // output is written at exit.
+    void enable(std::string const& path);
+
+    // samples per second of cpu time.
+    void set_hz(int hz) {
+      this->hz = hz > 0 ? hz : DefaultHz;
+    }
+
+    bool is_enabled() const {
+      return enabled;
+    }
+
+    // start sampling the context on current thread.
+    bool start(Context* ctx);
+    void stop();
+
+    void write_collapsed(std::string const& path) const;
+
+    size_t get_sample_count() const {
+      return sample_count;
+    }
+
+    size_t get_dropped_count() const {
+      return dropped;
+    }
+
+  private:
+    struct Record {
+      Function const* func;
+      size_t pc;
+    };
+
+    struct Sample {
+      size_t begin; // index of records (innermost frame first)
+      size_t depth;
+    };
+
+    bool enabled = false;
+    bool running = false;
+
+    std::string path;
+    int hz = DefaultHz;
+
+    Context* volatile ctx = nullptr;
+
+    // written only in the signal handler while running.
+    std::unique_ptr<Record[]> records;
+    std::unique_ptr<Sample[]> samples;
+    size_t record_cap = 0;
+    size_t sample_cap = 0;
+    volatile size_t record_count = 0;
+    volatile size_t sample_count = 0;
+    volatile size_t dropped = 0;
+
+    timer_t timer = {};
+    struct sigaction old_action = {};
+
+    Profiler() = default;
+
+    static void on_sigprof(int sig, siginfo_t* info, void* uctx);
+
+    static void finish();
+  };
+
+} // namespace fire::VM
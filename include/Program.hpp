@@ -0,0 +1,102 @@
+#pragma once
+
+#include <ctime>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "SourceFile.hpp"
+
+namespace fire {
+
+  struct Node;
+  class ConstantPool;
+  class Sema;
+
+  //
+  // Program
+  //   a main file and its imports, built again and again. (watch mode, daemon)
+  //
+  //   items parsed from each file are kept in memory. a changed file is read
+  //   and parsed again as a new version, and Sema checks again only changed
+  //   items and their dependents. (see Sema::reanalyze) files which have
+  //   dependents are parsed again from their tokens.
+  //
+  //   files are kept in own registry, since nodes are specific to a Sema.
+  class Program {
+  public:
+    explicit Program(std::string const& path);
+
+    SourceFile::Registry const& get_registry() const {
+      return registry;
+    }
+
+    // run front end and lower. returns exit code, same as one-shot run.
+    int build();
+
+    // changes of a path found by watcher. false if nothing to build again.
+    bool update_path(std::string const& path);
+
+    // check all files by modification time and contents.
+    // false if nothing to build again.
+    bool refresh();
+
+    // files parsed, and items checked by Sema in last build.
+    size_t get_parsed_count() const {
+      return parsed_count;
+    }
+
+    size_t get_checked_count() const {
+      return checked_count;
+    }
+
+  private:
+    // file status at last read.
+    struct Stamp {
+      timespec mtime = {};
+      off_t size = 0;
+    };
+
+    std::string path;
+
+    SourceFile::Registry registry;
+    SourceFile* main_file = nullptr;
+
+    ConstantPool* pool = nullptr;
+    Sema* sema = nullptr;
+
+    std::unordered_map<std::string, Stamp> stamps; // path -> stamp
+
+    // removed files. (their importers are built again when restored)
+    std::unordered_set<std::string> missing;
+
+    // replaced versions. (their nodes may be referred from Sema)
+    std::vector<SourceFile*> retired;
+
+    size_t parsed_count = 0;
+    size_t checked_count = 0;
+
+    int run_pipeline();
+
+    // items of all files.
+    std::vector<Node*> collect();
+
+    // items of the file and its imports. (imports first)
+    void collect_items(SourceFile* src, std::unordered_set<SourceFile*>& visited,
+                       std::vector<Node*>& items);
+
+    void parse_file(SourceFile* src);
+
+    // the file is read again. false if not changed.
+    bool reload_file(SourceFile* src);
+
+    void replace_file(SourceFile* old, SourceFile* src);
+
+    // importers of the file are parsed again. (imports are resolved again)
+    void invalidate_importers(SourceFile const* src);
+
+    void update_stamps();
+  };
+
+} // namespace fire
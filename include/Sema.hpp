@@ -1,5 +1,10 @@
 #pragma once
 
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
 #include "Utils.hpp"
 #include "Node.hpp"
 
@@ -76,6 +81,7 @@ namespace fire {
     Catch,
     If,
     For,
+    While,
     Func,
     Enum,
     Class,
@@ -99,7 +105,7 @@ namespace fire {
 
     virtual ~Scope() = default;
 
-    Scope* from_node(Node* node, Scope* parent);
+    static Scope* from_node(Node* node, Scope* parent);
 
   protected:
     Scope(ScopeKind kind, Node* node, Scope* parent);
@@ -127,6 +133,13 @@ namespace fire {
     SCFor(NdFor* node, Scope* parent);
   };
 
+  struct SCWhile : Scope {
+    Symbol* var = nullptr;
+    SCScope* body = nullptr;
+
+    SCWhile(NdWhile* node, Scope* parent);
+  };
+
   struct SCCatch : Scope {
     Symbol* holder_name = nullptr;
     SCScope* body = nullptr;
@@ -158,6 +171,9 @@ namespace fire {
     SymbolTable fields;
     SymbolTable methods;
 
+    SCClass* base = nullptr;
+    std::vector<SCClass*> derived; // direct subclasses
+
     NdClass* get_node() {
       return node->as<NdClass>();
     }
@@ -234,6 +250,9 @@ namespace fire {
     SCFunction* cur_func = nullptr;
     bool in_method = false;
 
+    // item of module we are in. (for dependency tracking)
+    Node* cur_item = nullptr;
+
     //
     // element-type of empty-array
     TypeInfo* empty_array_element_type = nullptr;
@@ -253,6 +272,7 @@ namespace fire {
 
     bool as_arg_of_callfunc = false;
     NdCallFunc* parent_cf_nd = nullptr;
+    std::vector<TypeInfo> const* arg_types_ptr = nullptr; // of parent_cf_nd (evaluated already)
     TypeInfo* self_ty_ptr = nullptr;
 
     NdEnumeratorDef** enumerator_node_out = nullptr;
@@ -274,6 +294,7 @@ namespace fire {
       if(ctx.as_callee_of_callfunc) flags+=format("as_callee_of_callfunc: %d,", ctx.as_callee_of_callfunc);
       if(ctx.as_arg_of_callfunc) flags+=format("as_arg_of_callfunc: %d,", ctx.as_arg_of_callfunc);
       if(ctx.parent_cf_nd) flags+=format("parent_cf_nd: %p,", ctx.parent_cf_nd);
+      if(ctx.arg_types_ptr) flags+=format("arg_types_ptr: %p,", ctx.arg_types_ptr);
       if(ctx.self_ty_ptr) flags+=format("self_ty_ptr: %p,", ctx.self_ty_ptr);
       if(ctx.enumerator_node_out) flags+=format("enumerator_node_out: %p,", ctx.enumerator_node_out);
       return "{"+flags+"}";
@@ -338,17 +359,44 @@ namespace fire {
         TypeInfo& self_ty, std::vector<TypeInfo> const& defs, std::vector<TypeInfo>& actual);
 
     TypeInfo case_call_func(NdCallFunc* cf, NdVisitorContext ctx);
-    TypeInfo case_method_call(NdCallFunc* cf, NdVisitorContext ctx);
+    TypeInfo case_method_call(NdCallFunc* cf, TypeInfo& self_ty, std::vector<TypeInfo>& arg_types,
+                              NdVisitorContext ctx);
+
+    // search method in the class and its bases.
+    NdFunction* find_method(SCClass* C, std::string_view name);
+
+    // true if any subclass of C overrides the method.
+    bool is_overridden(SCClass* C, std::string_view name);
 
     TypeInfo case_construct_enumerator(
       NdCallFunc* cf, NdEnumeratorDef* en_def, TypeInfo& callee_ty,
       size_t argc_give, std::vector<TypeInfo>& arg_types, NdVisitorContext ctx);
 
     TypeInfo eval_expr_ty(Node* node, NdVisitorContext ctx);
+
+    // type of "lhs op rhs".
+    TypeInfo eval_binary_ty(NodeKind op, Token const& tok, TypeInfo const& lhs_ty,
+                            TypeInfo const& rhs_ty);
+
+    // true if "s = s + x" or "s += x" on a string variable s in a loop.
+    bool is_string_append_in_loop(Node* lhs, Node* rhs_lhs, TypeInfo const& lhs_ty,
+                                  NdVisitorContext const& ctx);
     TypeInfo eval_typename_ty(NdSymbol* node, NdVisitorContext ctx);
 
     TypeInfo make_class_type(NdClass* node);
 
+    TypeInfo make_function_type(NdFunction* node);
+
+    // template arguments from "f<T, ...>" or deduced from arguments of the call.
+    std::vector<TypeInfo> get_template_args(NdTemplatableBase* templ, NdSymbol* sym,
+                                            NdVisitorContext ctx);
+
+    bool deduce_template_arg(NdSymbol* pattern, TypeInfo const& actual,
+                             NdTemplatableBase* templ, std::vector<TypeInfo const*>& out);
+
+    // base classes are evaluated before building the layout.
+    VM::ClassLayout* get_class_layout(NdClass* node);
+
     TypeInfo make_enum_type(NdEnum* node);
 
     void check_expr(Node* node, NdVisitorContext ctx);
@@ -356,30 +404,137 @@ namespace fire {
     void check_scope(NdScope* node, NdVisitorContext ctx);
     void check_function(NdFunction* node, NdVisitorContext ctx);
     void check_class(NdClass* node, NdVisitorContext ctx);
+
+    // signatures are checked before bodies, and then
+    // bodies of functions are checked in parallel.
+    void check_function_signature(NdFunction* node, NdVisitorContext ctx);
+    void check_function_body(NdFunction* node, NdVisitorContext ctx);
+    void check_class_signature(NdClass* node, NdVisitorContext ctx);
+    void check_class_body(NdClass* node, NdVisitorContext ctx);
+
     void check_enum(NdEnum* node, NdVisitorContext ctx);
     void check_namespace(NdNamespace* node, NdVisitorContext ctx);
+    void check_namespace_body(NdNamespace* node, NdVisitorContext ctx);
     void check_module(NdModule* node, NdVisitorContext ctx);
   };
 
+  //
+  // TemplateInstance
+  //   one specialized and type-checked copy per distinct arguments.
+  struct TemplateInstance {
+    NdTemplatableBase* templ = nullptr;
+    std::vector<TypeInfo const*> args; // interned
+    NdTemplatableBase* node = nullptr; // specialized copy
+
+    std::string get_name() const;
+  };
+
+  struct TemplateInstanceKey {
+    NdTemplatableBase* templ = nullptr;
+    std::vector<TypeInfo const*> args;
+
+    bool operator==(TemplateInstanceKey const& k) const {
+      return templ == k.templ && args == k.args;
+    }
+  };
+
+  struct TemplateInstanceKeyHash {
+    size_t operator()(TemplateInstanceKey const& k) const {
+      size_t h = std::hash<void*>()(k.templ);
+      for (auto a : k.args)
+        h = h * 31 + std::hash<void const*>()(a);
+      return h;
+    }
+  };
+
+  //
+  // ItemInfo
+  //   infos of an item of module, for incremental analysis.
+  struct ItemInfo {
+    std::string key;       // "<kind>:<name>#<n>"
+    std::string name;
+    std::string base_name; // base class (only for class)
+    size_t fingerprint = 0;
+
+    bool analyzed = false;
+
+    // names of module items referenced from this item.
+    std::unordered_set<std::string> deps;
+  };
+
   struct SymbolFindResult {
     NdSymbol* node = nullptr;
     NdSymbol* previous = nullptr; // "a" of "a::b"
     std::vector<Symbol*> hits = {};
   };
 
+  class ThreadPool;
+
   class Sema {
 
     friend class NameResolver;
+    friend class TypeChecker;
 
     SCModule* root_scope = nullptr;
 
+    std::unordered_map<TemplateInstanceKey, TemplateInstance*, TemplateInstanceKeyHash>
+        template_instances;
+
+    // guards template instances, and links between classes made by instantiation.
+    std::recursive_mutex instance_mtx;
+
+    std::vector<TemplateInstance*> template_instance_list; // in order of creation
+
+    NdModule* cur_module = nullptr;
+
+    std::unordered_map<Node*, ItemInfo> item_infos;
+
+    size_t jobs = 1; // 0 = count of cores
+
+    ThreadPool* pool = nullptr;
+
   public:
     static Sema& get_instance();
 
+    // another instance with its own state. (for each document of language server)
+    // threads are shared with the global instance.
+    static Sema* create();
+
+    // get specialized copy of the template for the arguments.
+    // the copy is created, name-resolved and type-checked only at the first time.
+    TemplateInstance* instantiate(NdTemplatableBase* templ, std::vector<TypeInfo> const& args,
+                                  Token const& tok);
+
+    std::vector<TemplateInstance*> const& get_template_instances() const {
+      return template_instance_list;
+    }
+
     static void analyze_all(NdModule* mod);
 
     void analyze_full(NdModule* mod);
 
+    // analyze re-parsed module.
+    // items not changed from previous analysis and not depending on changed ones
+    // are taken over, and only the rest are resolved and checked.
+    // returns count of re-checked items.
+    size_t reanalyze(NdModule* mod);
+
+    // analyzed nodes in items which reanalyze() would check again.
+    // they must be replaced with newly parsed ones before calling it.
+    std::vector<Node*> get_stale_items(std::vector<Node*> const& items);
+
+    bool is_analyzed(Node* item) const;
+    void mark_analyzed(Node* item);
+
+    // count of threads to check function bodies.
+    void set_jobs(size_t n) {
+      jobs = n;
+    }
+
+    // run fn(0) ... fn(count - 1) on the thread pool, and wait for all.
+    // if some of them throw, rethrows the one of smallest index.
+    void run_parallel(size_t count, std::function<void(size_t)> fn);
+
     Symbol* new_variable_symbol(NdLet* let);
 
     Symbol* new_variable_symbol(Token* tok, std::string_view name);
@@ -388,6 +543,24 @@ namespace fire {
     Sema();
 
     SymbolFindResult find_symbol(NdSymbol* node, NdVisitorContext ctx);
+
+    void add_dependency(Node* item, std::string_view name);
+
+    // true if the scope is not reachable from current root scope.
+    bool is_stale(Scope* scope) const;
+    bool refers_to_stale(TypeInfo const& ty) const;
+
+    void register_items(NdModule* mod);
+
+    // items of current module. (key -> item)
+    std::unordered_map<std::string, Node*> get_items_by_key();
+
+    // names of items to be checked again, and their dependents.
+    std::unordered_set<std::string> get_dirty_names(
+        std::vector<ItemInfo> const& new_infos,
+        std::unordered_map<std::string, Node*> const& old_items);
+
+    void prune_stale(Scope* scope, Scope* old_root);
   };
 
 } // namespace fire
\ No newline at end of file
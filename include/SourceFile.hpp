@@ -2,31 +2,45 @@
 
 #include <vector>
 #include <string>
+#include <unordered_map>
 
 #include "FileSystem.hpp"
+#include "StringArena.hpp"
 
 namespace fire {
   struct Token;
   struct NdModule;
+  class ConstantPool;
 
   struct SourceFile {
+    // files of a program. (absolute path -> file)
+    using Registry = std::unordered_map<std::string, SourceFile*>;
+
     std::string path;
     std::string data;
     size_t length = 0;
 
     SourceFile* parent = nullptr;
     std::vector<SourceFile*> imports;
+    std::vector<std::string> import_dirs; // imported folders
 
     bool is_node_imported = false;
 
+    // decoded string literals which have escapes.
+    mutable StringArena strings;
+
     Token* lexed_token = nullptr;
     NdModule* parsed_mod = nullptr;
 
     SourceFile(std::string const& _path);
 
+    // source on memory. (generated sources, benchmarks)
+    SourceFile(std::string const& _path, std::string _data);
+
     Token* lex();
 
-    NdModule* parse();
+    // literals are added to the pool if given. (for imported files)
+    NdModule* parse(ConstantPool* pool = nullptr);
 
     SourceFile* import(std::string const& _path);
 
@@ -36,6 +50,19 @@ namespace fire {
 
     std::string get_folder() const;
 
+    // read the file again as a new version, and register it instead of this.
+    // (null if the file can't be read)
+    SourceFile* reload() const;
+
+    // null if the file can't be read. (instead of exit)
+    static SourceFile* read(std::string const& _path);
+
+    // files are registered to, and imported from the registry.
+    // (language server has one for each document; null is the default one)
+    static void set_registry(Registry* reg);
+
+    static Registry& get_registry();
+
     char operator[](size_t const _index) const { return data[_index]; }
   };
 
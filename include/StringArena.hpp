@@ -0,0 +1,31 @@
+#pragma once
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace fire {
+
+  //
+  // StringArena
+  //   storage of strings which live as long as the owner.
+  //   strings are copied into big blocks, and freed at once.
+  class StringArena {
+  public:
+    static constexpr size_t BlockSize = 4096;
+
+    std::string_view store(std::string_view str);
+
+    size_t get_used() const {
+      return used;
+    }
+
+  private:
+    std::vector<std::unique_ptr<char[]>> blocks;
+
+    char* cur = nullptr;
+    size_t left = 0;
+    size_t used = 0;
+  };
+
+} // namespace fire
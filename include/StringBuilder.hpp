@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+
+#include "Object.hpp"
+
+namespace fire {
+
+  //
+  // StringBuilder
+  //   string being built by appending. (amortized O(1) per unit)
+  //
+  //   "s += x" and "s = s + x" of string in a loop are marked by Sema
+  //   (use_builder) as candidates. lowering doesn't use the mark yet; it's
+  //   for the VM to hold the variable in a builder while the loop runs,
+  //   and to take a copy by snapshot() for other reads of it in the loop.
+  class StringBuilder {
+  public:
+    StringBuilder() = default;
+
+    explicit StringBuilder(ObjString const* init) : buf(init->data) {
+    }
+
+    void append(char16_t c) {
+      buf.push_back(c);
+    }
+
+    void append(char16_t const* str, size_t len) {
+      buf.insert(buf.end(), str, str + len);
+    }
+
+    void append(ObjString const* str) {
+      append(str->data.data(), str->data.size());
+    }
+
+    // string or char.
+    void append(Object const* obj);
+
+    size_t length() const {
+      return buf.size();
+    }
+
+    // copy of current string.
+    ObjString* snapshot() const;
+
+    // the string built. (builder is empty after this)
+    ObjString* finish();
+
+  private:
+    std::vector<char16_t> buf;
+  };
+
+} // namespace fire
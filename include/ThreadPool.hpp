@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fire {
+
+  //
+  // ThreadPool
+  //   work-stealing pool.
+  //   each worker has its own queue; it takes tasks from the back of its own queue,
+  //   and steals from the front of others' when it's empty.
+  class ThreadPool {
+  public:
+    using Task = std::function<void()>;
+
+    explicit ThreadPool(size_t count = default_size());
+    ~ThreadPool();
+
+    // a task submitted from a worker goes to the worker's own queue.
+    void submit(Task task);
+
+    // wait for all submitted tasks. the caller also runs tasks while waiting.
+    void wait();
+
+    size_t size() const {
+      return threads.size();
+    }
+
+    static size_t default_size();
+
+  private:
+    struct Queue {
+      std::mutex mtx;
+      std::deque<Task> tasks;
+    };
+
+    // queues[size()] is for the thread calling wait().
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threads;
+
+    std::mutex mtx;
+    std::condition_variable cv_task;
+    std::condition_variable cv_done;
+
+    std::atomic<size_t> queued = 0;  // tasks in the queues
+    std::atomic<size_t> pending = 0; // tasks not finished yet
+    std::atomic<size_t> next_queue = 0;
+
+    bool stop = false;
+
+    bool pop(size_t index, Task& out);
+    void run(Task& task);
+
+    void worker_main(size_t index);
+  };
+
+} // namespace fire
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+namespace fire {
+
+  //
+  // TimeReport
+  //   wall time, cpu time, allocations and peak RSS of each phase of the compiler.
+  //   enabled by "--time-report".
+  //
+  //   phases may be nested (parsing a file parses imported files),
+  //   so the values of an entry don't include the nested phases.
+  class TimeReport {
+  public:
+    struct Stats {
+      double wall_ms = 0;
+      double cpu_ms = 0;    // all threads of the process
+      size_t allocs = 0;    // count of operator new (see AllocCounter)
+      size_t alloc_bytes = 0;
+      size_t peak_rss_kb = 0; // at the end of the phase
+
+      Stats& operator+=(Stats const& s);
+      Stats operator-(Stats const& s) const;
+    };
+
+    struct Entry {
+      std::string file;
+      std::string phase;
+      Stats stats;
+    };
+
+    //
+    // Phase
+    //   measures from construction to destruction. (only on driver thread)
+    class Phase {
+      bool active = false;
+
+    public:
+      Phase(char const* phase, std::string const& file);
+      ~Phase();
+
+      Phase(Phase const&) = delete;
+      Phase& operator=(Phase const&) = delete;
+    };
+
+    static TimeReport& get_instance();
+
+    // json_path: write JSON into the file instead of text to stderr.
+    void enable(std::string const& json_path = "");
+
+    bool is_enabled() const {
+      return enabled;
+    }
+
+    void print() const;
+    void write_json(std::string const& path) const;
+
+    static Stats now();
+
+  private:
+    struct Frame {
+      std::string file;
+      std::string phase;
+      Stats start;
+      Stats nested; // total of nested phases
+    };
+
+    bool enabled = false;
+    std::string json_path;
+
+    Stats start; // at enable()
+
+    std::vector<Frame> frames; // open phases
+    std::vector<Entry> entries;
+
+    TimeReport() = default;
+
+    void begin(char const* phase, std::string const& file);
+    void end();
+
+    // close all phases and print. (registered to atexit)
+    static void finish();
+  };
+
+  //
+  // AllocCounter
+  //   counted by operator new of the "fire" executable, after --time-report.
+  //   (src/AllocCounter.cpp; other programs of fire_core don't count)
+  struct AllocCounter {
+    static inline std::atomic<bool> enabled = false;
+    static inline std::atomic<size_t> count = 0;
+    static inline std::atomic<size_t> bytes = 0;
+  };
+
+} // namespace fire
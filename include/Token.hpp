@@ -2,6 +2,7 @@
 
 #include <cstring>
 #include <cstddef>
+#include <cstdint>
 #include <string_view>
 
 namespace fire {
@@ -105,6 +106,16 @@ namespace fire {
 
     Object* literal_obj = nullptr;
 
+    // content of String or Char literal, without quotes and escapes.
+    // (a slice of the source, or in the string arena of the source)
+    std::string_view str_value;
+
+    // value of Int or Float literal. (parsed by the lexer)
+    union {
+      std::int64_t int_value = 0;
+      double float_value;
+    };
+
     Token(TokenKind kind = TokenKind::Unknown) : kind(kind) {}
 
     Token(TokenKind k, std::string_view text, Token* prev, SourceFile const* src, size_t pos)
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fire {
+
+  //
+  // Tracer
+  //   writes spans of the compiler in Chrome Trace Event format.
+  //   (can be opened with Perfetto or chrome://tracing)
+  //   enabled by "--trace-out=<file>".
+  class Tracer {
+  public:
+    //
+    // Span
+    //   a "complete" event from construction to destruction.
+    //   spans on same thread are nested by their time.
+    class Span {
+      long index = -1;
+
+    public:
+      Span(char const* category, std::string_view name, std::string_view file = {});
+      ~Span();
+
+      Span(Span const&) = delete;
+      Span& operator=(Span const&) = delete;
+    };
+
+    static Tracer& get_instance();
+
+    void enable(std::string const& path);
+
+    bool is_enabled() const {
+      return enabled;
+    }
+
+    void write(std::string const& path);
+
+  private:
+    struct Event {
+      std::string name;
+      char const* category = "";
+      std::string file;
+      double ts_us = 0;
+      double dur_us = -1; // < 0 if not ended yet
+      int tid = 0;
+    };
+
+    bool enabled = false;
+    std::string path;
+
+    std::mutex mtx;
+    std::vector<Event> events;
+
+    Tracer() = default;
+
+    long begin(char const* category, std::string_view name, std::string_view file);
+    void end(long index);
+
+    static double now_us();
+
+    // the compiler may stop by exit(), so written in atexit.
+    static void finish();
+  };
+
+} // namespace fire
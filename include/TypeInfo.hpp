@@ -55,6 +55,12 @@ namespace fire {
 
     std::string to_string() const;
 
+    size_t hash() const;
+
+    // returns unique pointer for each distinct type.
+    // two interned types are the same type if and only if the pointers are equal.
+    static TypeInfo const* intern(TypeInfo const& t);
+
     static int required_param_count(TypeKind K) {
       if (K == TypeKind::Vector)
         return 1; // <element_type>
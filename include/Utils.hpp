@@ -34,7 +34,7 @@
 #define COL_BK_CYAN "\033[46;5m"
 #define COL_BK_WHITE "\033[47m"
 
-#define todoimpl (fprintf(stderr, "\t#todoimpl at %s:%d\n", __FILE__, __LINE__), exit(22))
+#define todoimpl fire::todo_reached(__FILE__, __LINE__)
 
 #define todo todoimpl
 
@@ -71,9 +71,23 @@ namespace fire {
 
   std::string node2s(Node* node);
 
+  // quoted and escaped string literal of JSON.
+  std::string json_string(std::string_view s);
+
+  // thrown by todo instead of exit, if enabled. (language server)
+  struct todo_error {
+    char const* file;
+    int line;
+  };
+
+  // prints the location and exits with 22, or throws todo_error.
+  [[noreturn]] void todo_reached(char const* file, int line);
+
+  void set_todo_throws(bool enable);
+
   template <typename... Args>
   std::string format(std::string const& fmt, Args&&... args) {
-    static char buffer[0x1000];
+    static thread_local char buffer[0x1000];
     std::snprintf(buffer, std::size(buffer), fmt.c_str(), std::forward<Args>(args)...);
     return buffer;
   }
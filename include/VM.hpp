@@ -0,0 +1,222 @@
+/*
+
+## VM: 実行時の構造
+
+## 例外 (try-catch)
+  - setjmp や handler の push は使わない
+  - 関数ごとに ExceptionTable ( pc の範囲 --> handler ) を持つ
+  - try に入るときのコストは 0
+  - throw されたときだけ表を検索し、フレームを巻き戻す
+  - finally の handler は prologue で例外をフレームのスロットに移し、最後にそれを rethrow する
+    (入れ子の try-finally とスロットを共有しない)
+
+## プロファイラ
+  - SIGPROF で Context のフレームをたどり、サンプルを記録する
+  - pc から LineEntry で Token (行) を引く
+
+*/
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <string_view>
+
+#include "Object.hpp"
+
+namespace fire {
+  struct Token;
+  struct NdLet;
+  struct NdFunction;
+  struct NdClass;
+  struct NdCallFunc;
+}
+
+namespace fire::VM {
+
+  struct ExceptionHandler {
+    size_t begin_pc = 0; // [begin_pc, end_pc)
+    size_t end_pc = 0;
+    size_t handler_pc = 0;
+
+    TypeInfo catch_type = {};
+
+    // catch-all handler of a finally block.
+    // runs the finally code and rethrows the pending exception.
+    bool is_finally = false;
+
+    bool covers(size_t pc) const {
+      return begin_pc <= pc && pc < end_pc;
+    }
+  };
+
+  struct ExceptionTable {
+    // inner try blocks always come before outer ones,
+    // so the first hit is the innermost handler.
+    std::vector<ExceptionHandler> handlers;
+
+    ExceptionHandler const* find(size_t pc, TypeInfo const& thrown) const;
+
+    bool empty() const {
+      return handlers.empty();
+    }
+
+    static bool can_catch(TypeInfo const& catch_type, TypeInfo const& thrown);
+  };
+
+  //
+  // ExceptionTableBuilder
+  //   used by code emitters.
+  //   a try region is appended when it is closed, so nested regions are
+  //   naturally ordered inner-first.
+  class ExceptionTableBuilder {
+    struct Region {
+      size_t begin_pc;
+      size_t end_pc;
+      std::vector<ExceptionHandler> handlers;
+    };
+
+    ExceptionTable& table;
+    std::vector<Region> regions;
+
+  public:
+    ExceptionTableBuilder(ExceptionTable& table) : table(table) {
+    }
+
+    void begin_try(size_t pc);
+    void end_try_body(size_t pc);
+
+    void add_catch(TypeInfo const& type, size_t handler_pc);
+
+    // covers the try body and all catch bodies.
+    void add_finally(size_t catch_end_pc, size_t handler_pc);
+
+    void end_try();
+  };
+
+  struct ClassLayout {
+    struct Field {
+      NdLet* node = nullptr;
+      std::string_view name;
+      size_t offset = 0; // index of slot
+    };
+
+    NdClass* node = nullptr;
+    ClassLayout const* base = nullptr;
+
+    std::vector<Field> fields; // ordered by offset
+    std::vector<NdFunction*> vtable;
+
+    size_t field_count() const {
+      return fields.size();
+    }
+
+    Field const* find_field(std::string_view name) const;
+
+    // build (or get already built) layout of the class.
+    static ClassLayout* of(NdClass* node);
+  };
+
+  //
+  // InlineCache
+  //   per call site of a virtual method call.
+  //   keyed on the class of the receiver.
+  //
+  //   Uninitialized --> Monomorphic --> Polymorphic --> Megamorphic
+  struct InlineCache {
+    static constexpr size_t MaxEntries = 4;
+
+    enum State {
+      Uninitialized,
+      Monomorphic,
+      Polymorphic,
+      Megamorphic,
+    };
+
+    struct Entry {
+      ClassLayout const* klass = nullptr;
+      NdFunction* method = nullptr;
+    };
+
+    NdCallFunc* call_site = nullptr;
+    std::string method_name;
+
+    State state = Uninitialized;
+    size_t count = 0;
+    Entry entries[MaxEntries];
+
+    size_t hits = 0;
+    size_t misses = 0;
+
+    InlineCache(NdCallFunc* call_site, std::string_view method_name)
+        : call_site(call_site), method_name(method_name) {
+    }
+
+    NdFunction* lookup(ClassLayout const* klass) {
+      for (size_t i = 0; i < count; i++) {
+        if (entries[i].klass == klass) {
+          hits++;
+          return entries[i].method;
+        }
+      }
+
+      return miss(klass);
+    }
+
+  private:
+    // slow path: look up vtable of the receiver's class.
+    NdFunction* miss(ClassLayout const* klass);
+  };
+
+  // code from `pc` to the next entry is made from `token`.
+  struct LineEntry {
+    size_t pc = 0;
+    Token const* token = nullptr;
+  };
+
+  struct Function {
+    NdFunction* node = nullptr;
+    ExceptionTable exceptions;
+
+    std::vector<LineEntry> lines; // ordered by pc
+
+    Token const* token_of(size_t pc) const;
+  };
+
+  struct Frame {
+    Function const* func = nullptr;
+    size_t pc = 0;
+    Frame* prev = nullptr;
+  };
+
+  struct Context {
+    // innermost frame. (also read by Profiler from a signal handler)
+    Frame* volatile frame = nullptr;
+
+    // the frame must be fully built before it's visible to the signal handler.
+    void push_frame(Frame* f) {
+      f->prev = frame;
+      std::atomic_signal_fence(std::memory_order_release);
+      frame = f;
+    }
+
+    void pop_frame() {
+      frame = frame->prev;
+    }
+
+    // exception which a finally handler is entered with.
+    // (taken into a slot of the frame by its prologue, and rethrown from it)
+    Object* pending_exception = nullptr;
+
+    // exception caught by a catch handler. (bound to the holder by its prologue)
+    Object* caught_exception = nullptr;
+
+    // search handler from current frame to the outermost one.
+    // returns false if the exception is not caught by anyone. (or null)
+    bool raise(Object* exception);
+
+    // end of a finally handler. `exception` is the one its prologue took.
+    bool rethrow(Object* exception);
+  };
+
+} // namespace fire::VM
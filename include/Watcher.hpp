@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "Program.hpp"
+
+namespace fire {
+
+  //
+  // Watcher
+  //   "fire --watch": builds the program again when source files are changed.
+  //   (only changed files and dependents, see Program)
+  //
+  //   folders of files are watched by inotify, since editors often replace
+  //   a file by renaming.
+  class Watcher {
+  public:
+    explicit Watcher(std::string const& path);
+
+    ~Watcher();
+
+    // until interrupted. returns exit code if watching failed.
+    int run();
+
+  private:
+    Program program;
+
+    int fd = -1; // inotify
+
+    std::unordered_map<int, std::string> folders; // watch descriptor -> folder
+    std::unordered_set<std::string> watched;
+
+    void build();
+
+    // add watches of folders of all files.
+    bool watch_folders();
+
+    // paths changed in watched folders. (blocks until something changes)
+    std::unordered_set<std::string> wait_changes();
+  };
+
+} // namespace fire
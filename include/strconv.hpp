@@ -4,7 +4,7 @@
 #include <stddef.h>
 #include <uchar.h>
 
-// if out is null, allocate new buffer.
+// if out is null, allocate new buffer. (with malloc)
 
 char16_t* utf8_to_utf16(char16_t* out, char const* input);
 char* utf16_to_utf8(char* out, char16_t const* input);
@@ -12,31 +12,58 @@ char* utf16_to_utf8(char* out, char16_t const* input);
 char16_t* utf8_to_utf16_with_len(char16_t* out, char const* input, size_t len);
 char* utf16_to_utf8_with_len(char* out, char16_t const* input, size_t len);
 
-inline std::u16string utf8_to_utf16_cpp(char const* input) {
-  char16_t* converted = utf8_to_utf16(nullptr, input);
-  std::u16string str = converted;
-  delete[] converted;
-  return str;
-}
+// implementation of transcoders.
+// the best one for the cpu is selected at startup.
+enum strconv_impl {
+  STRCONV_SCALAR,
+  STRCONV_SSE4,
+  STRCONV_AVX2,
+};
 
-inline std::string utf16_to_utf8_cpp(char16_t const* input) {
-  char* converted = utf16_to_utf8(nullptr, input);
-  std::string str = converted;
-  delete[] converted;
-  return str;
-}
+// false if the cpu can't run it.
+bool strconv_set_impl(strconv_impl impl);
+
+strconv_impl strconv_get_impl();
+char const* strconv_impl_name(strconv_impl impl);
+
+//
+// streaming API
+//   lengths are in code units, and outputs have no NUL.
+//   invalid sequences become U+FFFD.
+
+// length of the output. (count only)
+size_t utf8_to_utf16_length(char const* input, size_t len);
+size_t utf16_to_utf8_length(char16_t const* input, size_t len);
+
+// upper bounds of the length of the output.
+constexpr size_t utf8_to_utf16_max_length(size_t len) { return len; }
+constexpr size_t utf16_to_utf8_max_length(size_t len) { return len * 3; }
+
+// writes into out, and returns the length written.
+// out must have room for the length. (or the upper bound)
+size_t utf8_to_utf16_into(char16_t* out, char const* input, size_t len);
+size_t utf16_to_utf8_into(char* out, char16_t const* input, size_t len);
+
+// appends to the end of out.
+void utf8_to_utf16_append(std::u16string& out, char const* input, size_t len);
+void utf16_to_utf8_append(std::string& out, char16_t const* input, size_t len);
 
 inline std::u16string utf8_to_utf16_len_cpp(char const* input, size_t len) {
-  char16_t* converted = utf8_to_utf16_with_len(nullptr, input, len);
-  std::u16string str = converted;
-  delete[] converted;
+  std::u16string str;
+  utf8_to_utf16_append(str, input, len);
   return str;
 }
 
 inline std::string utf16_to_utf8_len_cpp(char16_t const* input, size_t len) {
-  char* converted = utf16_to_utf8_with_len(nullptr, input, len);
-  std::string str = converted;
-  delete[] converted;
+  std::string str;
+  utf16_to_utf8_append(str, input, len);
   return str;
 }
 
+inline std::u16string utf8_to_utf16_cpp(char const* input) {
+  return utf8_to_utf16_len_cpp(input, std::char_traits<char>::length(input));
+}
+
+inline std::string utf16_to_utf8_cpp(char16_t const* input) {
+  return utf16_to_utf8_len_cpp(input, std::char_traits<char16_t>::length(input));
+}
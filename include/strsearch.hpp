@@ -0,0 +1,17 @@
+#pragma once
+
+#include <stddef.h>
+#include <uchar.h>
+
+// substring search in UTF-16 strings.
+// implementation (scalar, sse4, avx2) is the one selected by strconv_set_impl.
+
+#define U16_NPOS ((size_t)-1)
+
+// index of the first needle in hay, or U16_NPOS.
+// empty needle is found at 0.
+size_t u16_find(char16_t const* hay, size_t len, char16_t const* needle, size_t needle_len);
+
+// index of the last needle in hay, or U16_NPOS.
+// empty needle is found at len.
+size_t u16_rfind(char16_t const* hay, size_t len, char16_t const* needle, size_t needle_len);
@@ -0,0 +1,46 @@
+#include <cstdlib>
+#include <new>
+
+#include "TimeReport.hpp"
+
+//
+// operator new of the "fire" executable.
+// counts allocations for --time-report, only after it's enabled.
+
+using fire::AllocCounter;
+
+static void* counted_alloc(size_t size) {
+  if (AllocCounter::enabled.load(std::memory_order_relaxed)) {
+    AllocCounter::count.fetch_add(1, std::memory_order_relaxed);
+    AllocCounter::bytes.fetch_add(size, std::memory_order_relaxed);
+  }
+
+  if (void* p = std::malloc(size ? size : 1))
+    return p;
+
+  throw std::bad_alloc();
+}
+
+void* operator new(size_t size) {
+  return counted_alloc(size);
+}
+
+void* operator new[](size_t size) {
+  return counted_alloc(size);
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+  std::free(p);
+}
@@ -1,76 +1,346 @@
+#include <cstdio>
 #include <cstring>
 #include <cstdlib>
 
-#include <iostream>
 #include <string>
 
 #include "Object.hpp"
+#include "Output.hpp"
+#include "strsearch.hpp"
 #include "BuiltinFunc.hpp"
 
-#define IMPL(name) Object* impl_##name(std::vector<Object*>& args)
+#define IMPL(name) void impl_##name(Object* const* args, size_t argc, Object*& result)
+
+// fixed arity: fast entry point, and the slot one calls it.
+#define FAST1(name)                                                                                \
+  static Object* fast_##name(Object*);                                                             \
+  IMPL(name) {                                                                                     \
+    (void)argc;                                                                                    \
+    result = fast_##name(args[0]);                                                                 \
+  }                                                                                                \
+  static Object* fast_##name(Object* a0)
+
+#define FAST2(name)                                                                                \
+  static Object* fast_##name(Object*, Object*);                                                    \
+  IMPL(name) {                                                                                     \
+    (void)argc;                                                                                    \
+    result = fast_##name(args[0], args[1]);                                                        \
+  }                                                                                                \
+  static Object* fast_##name(Object* a0, Object* a1)
 
 namespace fire {
 
-  IMPL(print) {
-    ObjInt* ret = new ObjInt(0);
-    std::string s;
-    for (auto&& a : args) {
-      s = a->to_string();
-      ret->val += s.length() + 1;
-      std::cout << s << ' ';
+  static size_t print_args(Object* const* args, size_t argc) {
+    Output& out = Output::get_stdout();
+    size_t begin = out.get_total();
+
+    for (size_t i = 0; i < argc; i++) {
+      out.write_object(args[i]);
+      out.write(' ');
     }
-    return ret;
+
+    return out.get_total() - begin;
+  }
+
+  //
+  // print(...) -> int
+  //   returns count of bytes written.
+  //
+  IMPL(print) {
+    result = ObjInt::get(print_args(args, argc));
   }
 
   IMPL(println) {
-    ObjInt* x = impl_print(args)->as<ObjInt>();
-    std::cout << std::endl;
-    x->val++;
-    return x;
+    size_t n = print_args(args, argc);
+    Output::get_stdout().newline();
+    result = ObjInt::get(n + 1);
+  }
+
+  //
+  // flush() -> none
+  //   writes out buffered output of print.
+  //
+  IMPL(flush) {
+    (void)args;
+    (void)argc;
+    Output::get_stdout().flush();
+    result = Object::none;
+  }
+
+  static std::vector<char16_t> const& str_of(Object* obj) {
+    return obj->as<ObjString>()->data;
+  }
+
+  static ObjString* new_string(char16_t const* p, size_t len) {
+    auto s = new ObjString();
+    s->data.assign(p, p + len);
+    return s;
+  }
+
+  static ObjInt* index_or_minus(size_t index) {
+    return ObjInt::get(index == U16_NPOS ? -1 : (std::int64_t)index);
   }
 
   //
   // string::starts(self, string) -> bool
   //
-  IMPL(string_starts) {
-    ObjString* self = args[0]->as<ObjString>();
-    ObjString* prefix = args[1]->as<ObjString>();
-    return new ObjBool(std::memcmp(self->data.data(), prefix->data.data(), prefix->data.size() * sizeof(char16_t)) == 0);
+  FAST2(string_starts) {
+    auto& self = str_of(a0);
+    auto& prefix = str_of(a1);
+
+    return ObjBool::get(prefix.size() <= self.size() &&
+                        std::memcmp(self.data(), prefix.data(), prefix.size() * sizeof(char16_t)) == 0);
+  }
+
+  //
+  // string::ends(self, string) -> bool
+  //
+  FAST2(string_ends) {
+    auto& self = str_of(a0);
+    auto& suffix = str_of(a1);
+
+    return ObjBool::get(suffix.size() <= self.size() &&
+                        std::memcmp(self.data() + self.size() - suffix.size(), suffix.data(),
+                                    suffix.size() * sizeof(char16_t)) == 0);
+  }
+
+  //
+  // string::find(self, string) -> int
+  //   index of the first one, or -1.
+  //
+  FAST2(string_find) {
+    auto& self = str_of(a0);
+    auto& s = str_of(a1);
+
+    return index_or_minus(u16_find(self.data(), self.size(), s.data(), s.size()));
+  }
+
+  //
+  // string::rfind(self, string) -> int
+  //   index of the last one, or -1.
+  //
+  FAST2(string_rfind) {
+    auto& self = str_of(a0);
+    auto& s = str_of(a1);
+
+    return index_or_minus(u16_rfind(self.data(), self.size(), s.data(), s.size()));
+  }
+
+  //
+  // string::contains(self, string) -> bool
+  //
+  FAST2(string_contains) {
+    auto& self = str_of(a0);
+    auto& s = str_of(a1);
+
+    return ObjBool::get(u16_find(self.data(), self.size(), s.data(), s.size()) != U16_NPOS);
+  }
+
+  //
+  // string::split(self, string) -> vector<string>
+  //   empty separator splits into characters.
+  //
+  FAST2(string_split) {
+    auto& self = str_of(a0);
+    auto& sep = str_of(a1);
+
+    auto vec = new ObjVector();
+
+    if (sep.empty()) {
+      for (size_t i = 0; i < self.size();) {
+        // a surrogate pair is one character.
+        size_t n = i + 1 < self.size() && self[i] >= 0xD800 && self[i] <= 0xDBFF &&
+                           self[i + 1] >= 0xDC00 && self[i + 1] <= 0xDFFF
+                       ? 2
+                       : 1;
+
+        vec->append(new_string(self.data() + i, n));
+        i += n;
+      }
+
+      return vec;
+    }
+
+    char16_t const* p = self.data();
+    size_t left = self.size();
+
+    for (size_t i; (i = u16_find(p, left, sep.data(), sep.size())) != U16_NPOS;) {
+      vec->append(new_string(p, i));
+      p += i + sep.size();
+      left -= i + sep.size();
+    }
+
+    vec->append(new_string(p, left));
+
+    return vec;
+  }
+
+  //
+  // string::replace(self, from, to) -> string
+  //   replaces all. (nothing if from is empty)
+  //
+  IMPL(string_replace) {
+    (void)argc;
+
+    auto& self = str_of(args[0]);
+    auto& from = str_of(args[1]);
+    auto& to = str_of(args[2]);
+
+    auto out = new ObjString();
+
+    if (from.empty()) {
+      out->data = self;
+      result = out;
+      return;
+    }
+
+    char16_t const* p = self.data();
+    size_t left = self.size();
+
+    out->data.reserve(self.size());
+
+    for (size_t i; (i = u16_find(p, left, from.data(), from.size())) != U16_NPOS;) {
+      out->data.insert(out->data.end(), p, p + i);
+      out->data.insert(out->data.end(), to.begin(), to.end());
+      p += i + from.size();
+      left -= i + from.size();
+    }
+
+    out->data.insert(out->data.end(), p, p + left);
+
+    result = out;
+  }
+
+  //
+  // string::trim(self) -> string
+  //   removes white spaces at both ends.
+  //
+  FAST1(string_trim) {
+    auto& self = str_of(a0);
+
+    auto is_space = [](char16_t c) {
+      return c == u' ' || (c >= u'\t' && c <= u'\r');
+    };
+
+    size_t begin = 0, end = self.size();
+
+    while (begin < end && is_space(self[begin]))
+      begin++;
+
+    while (end > begin && is_space(self[end - 1]))
+      end--;
+
+    return new_string(self.data() + begin, end - begin);
   }
 
   //
   // vector::append(self, value) -> vector
   //
-  IMPL(vector_append) {
-    ObjVector* self = args[0]->as<ObjVector>();
-    self->append(args[1]);
-    return self;
+  FAST2(vector_append) {
+    a0->as<ObjVector>()->append(a1);
+    return a0;
   }
 
-  BuiltinFunc blt_print{
+  static BuiltinFunc blt_print{
       .name = "print",
       .is_var_args = true,
       .result_type = TypeKind::Int,
       .impl = impl_print,
   };
 
-  BuiltinFunc blt_println{
+  static BuiltinFunc blt_println{
       .name = "println",
       .is_var_args = true,
       .result_type = TypeKind::Int,
       .impl = impl_println,
   };
 
-  BuiltinFunc bltm_string_starts{
+  static BuiltinFunc blt_flush{
+      .name = "flush",
+      .is_var_args = false,
+      .result_type = TypeKind::None,
+      .impl = impl_flush,
+  };
+
+  static BuiltinFunc bltm_string_starts{
     .name = "starts",
     .is_var_args = false,
     .self_type = TypeKind::String,
     .arg_types = { TypeKind::String },
     .result_type = TypeKind::Bool,
     .impl = impl_string_starts,
+    .fast2 = fast_string_starts,
+  };
+
+  static BuiltinFunc bltm_string_ends{
+    .name = "ends",
+    .is_var_args = false,
+    .self_type = TypeKind::String,
+    .arg_types = { TypeKind::String },
+    .result_type = TypeKind::Bool,
+    .impl = impl_string_ends,
+    .fast2 = fast_string_ends,
+  };
+
+  static BuiltinFunc bltm_string_find{
+    .name = "find",
+    .is_var_args = false,
+    .self_type = TypeKind::String,
+    .arg_types = { TypeKind::String },
+    .result_type = TypeKind::Int,
+    .impl = impl_string_find,
+    .fast2 = fast_string_find,
+  };
+
+  static BuiltinFunc bltm_string_rfind{
+    .name = "rfind",
+    .is_var_args = false,
+    .self_type = TypeKind::String,
+    .arg_types = { TypeKind::String },
+    .result_type = TypeKind::Int,
+    .impl = impl_string_rfind,
+    .fast2 = fast_string_rfind,
   };
 
-  BuiltinFunc bltm_vector_append{
+  static BuiltinFunc bltm_string_contains{
+    .name = "contains",
+    .is_var_args = false,
+    .self_type = TypeKind::String,
+    .arg_types = { TypeKind::String },
+    .result_type = TypeKind::Bool,
+    .impl = impl_string_contains,
+    .fast2 = fast_string_contains,
+  };
+
+  static BuiltinFunc bltm_string_split{
+    .name = "split",
+    .is_var_args = false,
+    .self_type = TypeKind::String,
+    .arg_types = { TypeKind::String },
+    .result_type = TypeInfo(TypeKind::Vector, { TypeKind::String }, false, false),
+    .impl = impl_string_split,
+    .fast2 = fast_string_split,
+  };
+
+  static BuiltinFunc bltm_string_replace{
+    .name = "replace",
+    .is_var_args = false,
+    .self_type = TypeKind::String,
+    .arg_types = { TypeKind::String, TypeKind::String },
+    .result_type = TypeKind::String,
+    .impl = impl_string_replace,
+  };
+
+  static BuiltinFunc bltm_string_trim{
+    .name = "trim",
+    .is_var_args = false,
+    .self_type = TypeKind::String,
+    .result_type = TypeKind::String,
+    .impl = impl_string_trim,
+    .fast1 = fast_string_trim,
+  };
+
+  static BuiltinFunc bltm_vector_append{
     .name = "append",
     .is_var_args = false,
     .self_type = TypeKind::Vector,
@@ -78,6 +348,35 @@ namespace fire {
     .result_type = TypeKind::Vector,
     .returning_self = true,
     .impl = impl_vector_append,
+    .fast2 = fast_vector_append,
   };
 
-} // namespace fire
\ No newline at end of file
+  BuiltinRegistry& BuiltinRegistry::get_instance() {
+    static BuiltinRegistry inst;
+    return inst;
+  }
+
+  BuiltinRegistry::BuiltinRegistry() {
+    add_module("io", {&blt_print, &blt_println, &blt_flush});
+
+    add_module("string", {&bltm_string_starts, &bltm_string_ends, &bltm_string_find, &bltm_string_rfind,
+                          &bltm_string_contains, &bltm_string_split, &bltm_string_replace, &bltm_string_trim});
+
+    // vector::append(self, value)
+    add_module("vector", {&bltm_vector_append});
+  }
+
+  bool BuiltinRegistry::add(BuiltinFunc const* func) {
+    return table.try_emplace({func->self_type.kind, func->name}, func).second;
+  }
+
+  void BuiltinRegistry::add_module(char const* name, std::initializer_list<BuiltinFunc const*> funcs) {
+    modules.push_back(name);
+
+    for (auto func : funcs) {
+      if (!add(func))
+        fprintf(stderr, "builtin '%s' of module '%s' is already defined\n", func->name, name);
+    }
+  }
+
+} // namespace fire
@@ -0,0 +1,72 @@
+#include <cstring>
+
+#include "Utils.hpp"
+#include "Object.hpp"
+#include "ConstantPool.hpp"
+
+namespace fire {
+
+  size_t ConstantPool::append(Object* obj) {
+    constants.push_back(obj);
+    return constants.size() - 1;
+  }
+
+  size_t ConstantPool::add_none() {
+    if (none_index == npos)
+      none_index = append(Object::none);
+
+    return none_index;
+  }
+
+  size_t ConstantPool::add_bool(bool value) {
+    auto& index = bool_index[value];
+
+    if (index == npos)
+      index = append(ObjBool::get(value));
+
+    return index;
+  }
+
+  size_t ConstantPool::add_int(std::int64_t value) {
+    auto [it, inserted] = ints.try_emplace(value, constants.size());
+
+    if (inserted)
+      append(new ObjInt(value));
+
+    return it->second;
+  }
+
+  size_t ConstantPool::add_float(double value) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    auto [it, inserted] = floats.try_emplace(bits, constants.size());
+
+    if (inserted)
+      append(new ObjFloat(value));
+
+    return it->second;
+  }
+
+  size_t ConstantPool::add_char(char16_t value) {
+    auto [it, inserted] = chars.try_emplace(value, constants.size());
+
+    if (inserted)
+      append(new ObjChar(value));
+
+    return it->second;
+  }
+
+  size_t ConstantPool::add_string(std::u16string_view value) {
+    if (auto it = strings.find(value); it != strings.end())
+      return it->second;
+
+    auto str = new ObjString(std::vector<char16_t>(value.begin(), value.end()));
+    auto index = append(str);
+
+    strings.emplace(std::u16string_view(str->data.data(), str->data.size()), index);
+
+    return index;
+  }
+
+} // namespace fire
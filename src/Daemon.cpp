@@ -0,0 +1,465 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <cstdint>
+#include <iostream>
+#include <filesystem>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "Utils.hpp"
+#include "Error.hpp"
+#include "FileSystem.hpp"
+#include "Output.hpp"
+#include "Driver.hpp"
+#include "Program.hpp"
+#include "Daemon.hpp"
+
+//
+// protocol:
+//   request  = u32 size, strings (cwd, args...)  +  fds 0, 1, 2 (SCM_RIGHTS)
+//   string   = u32 length, bytes
+//   response = i32 exit code
+//
+
+namespace fire {
+
+  // larger requests are refused.
+  static constexpr uint32_t MaxRequestSize = 1 << 20;
+
+  // fds in a request. (more are received to close them)
+  static constexpr size_t MaxRequestFds = 16;
+
+  static bool write_all(int fd, void const* data, size_t size) {
+    auto ptr = static_cast<char const*>(data);
+
+    while (size > 0) {
+      ssize_t n = write(fd, ptr, size);
+
+      if (n < 0 && errno == EINTR)
+        continue;
+
+      if (n <= 0)
+        return false;
+
+      ptr += n;
+      size -= n;
+    }
+
+    return true;
+  }
+
+  static bool read_all(int fd, void* data, size_t size) {
+    auto ptr = static_cast<char*>(data);
+
+    while (size > 0) {
+      ssize_t n = read(fd, ptr, size);
+
+      if (n < 0 && errno == EINTR)
+        continue;
+
+      if (n <= 0)
+        return false;
+
+      ptr += n;
+      size -= n;
+    }
+
+    return true;
+  }
+
+  static void put_string(std::string& buf, std::string const& str) {
+    uint32_t len = str.length();
+
+    buf.append(reinterpret_cast<char const*>(&len), sizeof(len));
+    buf.append(str);
+  }
+
+  static bool get_strings(std::string const& buf, std::vector<std::string>& out) {
+    for (size_t pos = 0; pos < buf.length();) {
+      uint32_t len;
+
+      if (buf.length() - pos < sizeof(len))
+        return false;
+
+      std::memcpy(&len, buf.data() + pos, sizeof(len));
+      pos += sizeof(len);
+
+      if (buf.length() - pos < len)
+        return false;
+
+      out.emplace_back(buf.substr(pos, len));
+      pos += len;
+    }
+
+    return true;
+  }
+
+  static bool to_address(std::string const& path, sockaddr_un& addr) {
+    addr = {};
+    addr.sun_family = AF_UNIX;
+
+    if (path.length() >= sizeof(addr.sun_path))
+      return false;
+
+    std::memcpy(addr.sun_path, path.c_str(), path.length() + 1);
+
+    return true;
+  }
+
+  //
+  // the client gives its stdin/stdout/stderr to the daemon, so the other
+  // side must be run by the same user.
+  static bool is_same_user(int fd) {
+    ucred cred = {};
+    socklen_t len = sizeof(cred);
+
+    return getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) == 0 && cred.uid == getuid();
+  }
+
+  //
+  // folder of the default socket. (private to the user)
+  // others can't create a socket in it before the daemon.
+  static bool prepare_folder(std::string const& socket_path) {
+    auto folder = FileSystem::GetFolderOfFile(socket_path);
+
+    if (mkdir(folder.c_str(), 0700) != 0 && errno != EEXIST)
+      return false;
+
+    struct stat st;
+
+    return lstat(folder.c_str(), &st) == 0 && S_ISDIR(st.st_mode) && st.st_uid == getuid() &&
+           (st.st_mode & 077) == 0;
+  }
+
+  // all output of the compiler is written before fds are changed.
+  static void flush_all() {
+    Output::get_stdout().flush();
+    std::cout.flush();
+    std::fflush(stdout);
+    std::fflush(stderr);
+  }
+
+  Daemon::Daemon(std::string const& socket_path) : socket_path(socket_path) {
+  }
+
+  std::string Daemon::get_default_path() {
+    std::string base = "/tmp";
+
+    if (auto dir = std::getenv("XDG_RUNTIME_DIR"); dir && *dir)
+      base = dir;
+
+    return base + "/fire-" + std::to_string(getuid()) + "/daemon.sock";
+  }
+
+  int Daemon::run() {
+    sockaddr_un addr;
+
+    if (!to_address(socket_path, addr)) {
+      std::fprintf(stderr, "socket path is too long: %s\n", socket_path.c_str());
+      return 1;
+    }
+
+    if (socket_path == get_default_path() && !prepare_folder(socket_path)) {
+      std::fprintf(stderr, "folder of socket is not private: %s\n", socket_path.c_str());
+      return 1;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+    if (fd < 0) {
+      std::perror("socket");
+      return 1;
+    }
+
+    // a socket file left by a daemon which is not running is removed.
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) {
+      std::fprintf(stderr, "daemon is running already on %s\n", socket_path.c_str());
+      close(fd);
+      return 1;
+    }
+
+    unlink(socket_path.c_str());
+
+    // only the user can connect. (not depending on umask)
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        chmod(socket_path.c_str(), 0600) != 0 || listen(fd, 16) != 0) {
+      std::fprintf(stderr, "cannot listen on %s: %s\n", socket_path.c_str(), std::strerror(errno));
+      close(fd);
+      return 1;
+    }
+
+    // clients may exit before the response.
+    std::signal(SIGPIPE, SIG_IGN);
+
+    // "todo" in the compiler must not end the daemon.
+    set_todo_throws(true);
+
+    for (int i = 0; i < 3; i++)
+      saved_fds[i] = fcntl(i, F_DUPFD_CLOEXEC, 3);
+
+    std::fprintf(stderr, "listening on %s\n", socket_path.c_str());
+
+    while (true) {
+      int conn = accept4(fd, nullptr, nullptr, SOCK_CLOEXEC);
+
+      if (conn < 0) {
+        if (errno == EINTR || errno == ECONNABORTED)
+          continue;
+
+        std::perror("accept");
+        break;
+      }
+
+      if (is_same_user(conn))
+        serve(conn);
+
+      close(conn);
+    }
+
+    close(fd);
+    unlink(socket_path.c_str());
+
+    return 1;
+  }
+
+  void Daemon::serve(int conn) {
+    uint32_t size = 0;
+    int fds[MaxRequestFds];
+    size_t fd_count = 0;
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(fds))];
+
+    iovec iov = {.iov_base = &size, .iov_len = sizeof(size)};
+
+    msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    ssize_t n = recvmsg(conn, &msg, MSG_CMSG_CLOEXEC);
+
+    if (n <= 0)
+      return;
+
+    // all fds received are kept to close them.
+    for (auto cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+      if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+        continue;
+
+      size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+
+      for (size_t i = 0; i < count && fd_count < MaxRequestFds; i++)
+        std::memcpy(&fds[fd_count++], CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+    }
+
+    auto close_fds = [&] {
+      for (size_t i = 0; i < fd_count; i++)
+        close(fds[i]);
+
+      fd_count = 0;
+    };
+
+    std::string buf;
+    std::vector<std::string> strings;
+
+    // (too many fds are truncated, MSG_CTRUNC)
+    bool ok = fd_count == 3 && !(msg.msg_flags & MSG_CTRUNC) && read_all(conn, reinterpret_cast<char*>(&size) + n,
+                                        sizeof(size) - n);
+
+    if (ok && size <= MaxRequestSize) {
+      buf.resize(size);
+      ok = read_all(conn, buf.data(), size) && get_strings(buf, strings) && !strings.empty();
+    } else {
+      ok = false;
+    }
+
+    if (!ok) {
+      close_fds();
+      return;
+    }
+
+    std::vector<std::string> args(strings.begin() + 1, strings.end());
+
+    int code = Fallback;
+
+    for (auto& arg : args) {
+      // options change global state. (reports, traces)
+      if (arg.compare(0, 2, "--") == 0) {
+        close_fds();
+        write_all(conn, &code, sizeof(code));
+        return;
+      }
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+
+    flush_all();
+
+    for (int i = 0; i < 3; i++)
+      dup2(fds[i], i);
+
+    close_fds();
+
+    std::error_code ec;
+    std::filesystem::current_path(strings[0], ec);
+
+    // imports are searched until cwd of the client.
+    Driver::get_instance()->set_first_cwd(strings[0]);
+
+    try {
+      code = compile(args);
+    }
+    catch (err::e& e) {
+      e.print();
+      code = 1;
+    }
+    catch (todo_error& e) {
+      std::fprintf(stderr, "\t#todoimpl at %s:%d\n", e.file, e.line);
+      code = 22;
+    }
+    catch (std::exception& e) {
+      std::fprintf(stderr, "internal error: %s\n", e.what());
+      code = 1;
+    }
+    catch (...) {
+      std::fprintf(stderr, "internal error\n");
+      code = 1;
+    }
+
+    flush_all();
+
+    for (int i = 0; i < 3; i++)
+      dup2(saved_fds[i], i);
+
+    write_all(conn, &code, sizeof(code));
+
+    std::fprintf(stderr, "%s: exit %d in %.1f ms\n", args.empty() ? "-" : args[0].c_str(), code,
+                 std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin)
+                     .count());
+  }
+
+  int Daemon::compile(std::vector<std::string> const& args) {
+    if (args.empty()) {
+      std::cout << "no input files." << std::endl;
+      return -1;
+    }
+
+    requests++;
+
+    for (auto& arg : args) {
+      auto program = get_program(std::filesystem::absolute(arg).string());
+
+      program->refresh();
+
+      if (int code = program->build(); code != 1)
+        return code;
+    }
+
+    return 1;
+  }
+
+  Program* Daemon::get_program(std::string const& path) {
+    if (auto it = programs.find(path); it != programs.end()) {
+      it->second.last_used = requests;
+      return it->second.program;
+    }
+
+    // least recently used one is removed.
+    if (programs.size() >= MaxPrograms) {
+      auto oldest = programs.begin();
+
+      for (auto it = programs.begin(); it != programs.end(); it++) {
+        if (it->second.last_used < oldest->second.last_used)
+          oldest = it;
+      }
+
+      delete oldest->second.program;
+      programs.erase(oldest);
+    }
+
+    auto program = new Program(path);
+
+    programs[path] = {program, requests};
+
+    return program;
+  }
+
+  int Daemon::forward(std::string const& socket_path, std::vector<std::string> const& args) {
+    sockaddr_un addr;
+
+    if (!to_address(socket_path, addr))
+      return Fallback;
+
+    if (socket_path == get_default_path() && !prepare_folder(socket_path))
+      return Fallback;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+    if (fd < 0)
+      return Fallback;
+
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+      close(fd);
+      return Fallback;
+    }
+
+    if (!is_same_user(fd)) {
+      std::fprintf(stderr, "daemon on %s is run by another user. (not used)\n",
+                   socket_path.c_str());
+      close(fd);
+      return Fallback;
+    }
+
+    std::string buf(sizeof(uint32_t), 0);
+
+    put_string(buf, std::filesystem::current_path().string());
+
+    for (auto& arg : args)
+      put_string(buf, arg);
+
+    uint32_t size = buf.length() - sizeof(uint32_t);
+    std::memcpy(buf.data(), &size, sizeof(size));
+
+    int fds[3] = {STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO};
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(fds))] = {};
+
+    iovec iov = {.iov_base = buf.data(), .iov_len = buf.length()};
+
+    msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    auto cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+    std::memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+    ssize_t n = sendmsg(fd, &msg, MSG_NOSIGNAL);
+
+    int code = Fallback;
+
+    if (n <= 0 || !write_all(fd, buf.data() + n, buf.length() - n) ||
+        !read_all(fd, &code, sizeof(code))) {
+      std::fprintf(stderr, "connection to the daemon is lost.\n");
+      code = 1;
+    }
+
+    close(fd);
+
+    return code;
+  }
+
+} // namespace fire
@@ -1,7 +1,9 @@
 #include <iostream>
 #include <string>
 #include <filesystem>
+#include <cctype>
 #include <cstring>
+#include <unistd.h>
 
 
 #include "Lexer.hpp"
@@ -9,6 +11,12 @@
 #include "Parser.hpp"
 #include "Sema.hpp"
 #include "Lower.hpp"
+#include "TimeReport.hpp"
+#include "Trace.hpp"
+#include "Profiler.hpp"
+#include "LanguageServer.hpp"
+#include "Watcher.hpp"
+#include "Daemon.hpp"
 
 #include "Driver.hpp"
 
@@ -29,7 +37,28 @@ namespace fire {
 
     bool opt_print_ast = false;
     bool opt_print_tokens = false;
-    
+    bool opt_watch = false;
+
+    std::string socket_path = Daemon::get_default_path();
+    std::vector<std::string> forwarded;
+
+    bool opt_client = false;
+
+    for (int i = 1; i < argc; i++) {
+      if (std::strncmp(argv[i], "--socket=", 9) == 0)
+        socket_path = argv[i] + 9;
+      else if (std::strcmp(argv[i], "--client") == 0)
+        opt_client = true;
+      else
+        forwarded.emplace_back(argv[i]);
+    }
+
+    // run in the daemon if it's running. (or here)
+    if (opt_client) {
+      if (int code = Daemon::forward(socket_path, forwarded); code != Daemon::Fallback)
+        return code;
+    }
+
     for (int i = 1; i < argc; i++) {
       char const* arg = argv[i];
 
@@ -42,6 +71,60 @@ namespace fire {
         else if(std::strcmp(arg,"print-tokens")==0){
           opt_print_tokens=true;
         }
+        else if (std::strcmp(arg, "time-report") == 0) {
+          TimeReport::get_instance().enable();
+        }
+        else if (std::strncmp(arg, "time-report=", 12) == 0) {
+          // write JSON into the file
+          TimeReport::get_instance().enable(arg + 12);
+        }
+        else if (std::strncmp(arg, "trace-out=", 10) == 0) {
+          Tracer::get_instance().enable(arg + 10);
+        }
+        else if (std::strncmp(arg, "profile=", 8) == 0) {
+          // sampling profiler of the program. (collapsed stacks into the file)
+          VM::Profiler::get_instance().enable(arg + 8);
+        }
+        else if (std::strncmp(arg, "profile-hz=", 11) == 0) {
+          char* end = nullptr;
+          auto hz = std::strtol(arg + 11, &end, 10);
+
+          if (!std::isdigit(arg[11]) || *end || hz <= 0) {
+            std::cout << "invalid sampling rate: " << arg + 11 << std::endl;
+            return -1;
+          }
+
+          VM::Profiler::get_instance().set_hz(hz);
+        }
+        else if (std::strcmp(arg, "watch") == 0) {
+          // run again when files are changed.
+          opt_watch = true;
+        }
+        else if (std::strcmp(arg, "lsp") == 0) {
+          // language server on stdio. stdout is kept for messages only.
+          int out_fd = dup(STDOUT_FILENO);
+          dup2(STDERR_FILENO, STDOUT_FILENO);
+          return LSP::Server(out_fd).run();
+        }
+        else if (std::strcmp(arg, "daemon") == 0) {
+          // keep compiled programs in memory for clients.
+          return Daemon(socket_path).run();
+        }
+        else if (std::strcmp(arg, "client") == 0 || std::strncmp(arg, "socket=", 7) == 0) {
+          // see above.
+        }
+        else if (std::strncmp(arg, "jobs=", 5) == 0) {
+          // threads to check function bodies. (0 = count of cores)
+          char* end = nullptr;
+          auto n = std::strtoul(arg + 5, &end, 10);
+
+          if (!std::isdigit(arg[5]) || *end) {
+            std::cout << "invalid count of jobs: " << arg + 5 << std::endl;
+            return -1;
+          }
+
+          Sema::get_instance().set_jobs(n);
+        }
         else {
           std::cout << "unknown option: " << arg << std::endl;
           return -1;
@@ -56,6 +139,11 @@ namespace fire {
       return -1;
     }
 
+    if (opt_watch) {
+      std::filesystem::current_path(inputs[0]->get_folder());
+      return Watcher(inputs[0]->path).run();
+    }
+
     for (SourceFile* source : this->inputs) {
 
       std::filesystem::current_path(source->get_folder());
@@ -85,10 +173,22 @@ namespace fire {
           return -1;
         }
 
-        Sema::analyze_all(mod);
+        {
+          TimeReport::Phase _phase("sema", source->path);
+          Tracer::Span _span("sema", "sema", source->path);
+          Sema::analyze_all(mod);
+        }
+
+        TimeReport::Phase _phase("lower", source->path);
 
         IR::Low::LIR* low_ir = NodeLower::lower_full(mod);
 
+        // frames of the program are pushed to this context.
+        VM::Context ctx;
+
+        if (auto& P = VM::Profiler::get_instance(); P.is_enabled() && !P.start(&ctx))
+          std::cout << "cannot start the profiler." << std::endl;
+
         // if
         // (!mod->main_fn->scope_ptr->as<FunctionScope>()->result_type.equals(TypeInfo(TypeKind::Int)))
         // {
@@ -98,6 +198,8 @@ namespace fire {
 
         // Compiler::compile_full(IR::from_node(mod));
 
+        VM::Profiler::get_instance().stop();
+
         return 0;
       }
       catch (int n) {
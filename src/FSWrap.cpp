@@ -28,6 +28,13 @@ namespace fire {
     return (pos == std::string::npos) ? "" : path.substr(0, pos);
   }
 
+  std::string FileSystem::StripTrailingSlash(std::string path) {
+    while (path.length() > 1 && path.back() == '/')
+      path.pop_back();
+
+    return path;
+  }
+
   bool FileSystem::Exists(std::string const& path) {
     struct stat st;
     return stat(path.c_str(), &st) == 0;
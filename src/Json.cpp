@@ -0,0 +1,357 @@
+#include <charconv>
+#include <cmath>
+
+#include "Utils.hpp"
+#include "strconv.hpp"
+#include "Json.hpp"
+
+namespace fire {
+
+  static Json const null_json;
+  static std::string const empty_string;
+
+  std::string const& Json::as_string() const {
+    return kind == Kind::String ? str : empty_string;
+  }
+
+  size_t Json::size() const {
+    if (kind == Kind::Array)
+      return elems.size();
+
+    if (kind == Kind::Object)
+      return members.size();
+
+    return 0;
+  }
+
+  Json const& Json::operator[](std::string_view key) const {
+    for (auto& [k, v] : members) {
+      if (k == key)
+        return v;
+    }
+
+    return null_json;
+  }
+
+  Json const& Json::operator[](size_t index) const {
+    return index < elems.size() ? elems[index] : null_json;
+  }
+
+  Json& Json::set(std::string_view key, Json value) {
+    kind = Kind::Object;
+
+    for (auto& [k, v] : members) {
+      if (k == key) {
+        v = std::move(value);
+        return *this;
+      }
+    }
+
+    members.emplace_back(std::string(key), std::move(value));
+    return *this;
+  }
+
+  Json& Json::push(Json value) {
+    kind = Kind::Array;
+    elems.emplace_back(std::move(value));
+    return *this;
+  }
+
+  std::string Json::dump() const {
+    std::string out;
+    dump(out);
+    return out;
+  }
+
+  void Json::dump(std::string& out) const {
+    switch (kind) {
+      case Kind::Null:
+        out += "null";
+        break;
+
+      case Kind::Bool:
+        out += b ? "true" : "false";
+        break;
+
+      case Kind::Number: {
+        char buf[32];
+
+        if (!std::isfinite(num))
+          out += "null";
+        else
+          out.append(buf, std::to_chars(buf, buf + sizeof(buf), num).ptr);
+
+        break;
+      }
+
+      case Kind::String:
+        out += json_string(str);
+        break;
+
+      case Kind::Array:
+        out += '[';
+
+        for (size_t i = 0; i < elems.size(); i++) {
+          if (i)
+            out += ',';
+          elems[i].dump(out);
+        }
+
+        out += ']';
+        break;
+
+      case Kind::Object:
+        out += '{';
+
+        for (size_t i = 0; i < members.size(); i++) {
+          if (i)
+            out += ',';
+          out += json_string(members[i].first);
+          out += ':';
+          members[i].second.dump(out);
+        }
+
+        out += '}';
+        break;
+    }
+  }
+
+  //
+  // JsonParser
+  //   recursive descent. (depth is limited)
+  class JsonParser {
+    std::string_view text;
+    size_t pos = 0;
+    int depth = 0;
+
+    static constexpr int MaxDepth = 256;
+
+  public:
+    JsonParser(std::string_view text) : text(text) {
+    }
+
+    bool parse(Json& out) {
+      return parse_value(out) && (pass_space(), pos == text.length());
+    }
+
+  private:
+    void pass_space() {
+      while (pos < text.length() &&
+             (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\n' || text[pos] == '\r'))
+        pos++;
+    }
+
+    bool eat(std::string_view s) {
+      if (text.substr(pos, s.length()) != s)
+        return false;
+
+      pos += s.length();
+      return true;
+    }
+
+    bool parse_value(Json& out) {
+      pass_space();
+
+      if (pos >= text.length())
+        return false;
+
+      switch (text[pos]) {
+        case 'n':
+          out = nullptr;
+          return eat("null");
+
+        case 't':
+          out = true;
+          return eat("true");
+
+        case 'f':
+          out = false;
+          return eat("false");
+
+        case '"': {
+          std::string s;
+
+          if (!parse_string(s))
+            return false;
+
+          out = std::move(s);
+          return true;
+        }
+
+        case '[':
+          return parse_array(out);
+
+        case '{':
+          return parse_object(out);
+      }
+
+      return parse_number(out);
+    }
+
+    bool parse_number(Json& out) {
+      // from_chars doesn't accept '+', but JSON doesn't too.
+      double val = 0;
+      auto [ptr, ec] = std::from_chars(text.data() + pos, text.data() + text.length(), val);
+
+      if (ec != std::errc() || ptr == text.data() + pos)
+        return false;
+
+      pos = ptr - text.data();
+      out = val;
+      return true;
+    }
+
+    bool parse_hex4(char16_t& out) {
+      if (pos + 4 > text.length())
+        return false;
+
+      unsigned v = 0;
+      auto [ptr, ec] = std::from_chars(text.data() + pos, text.data() + pos + 4, v, 16);
+
+      if (ec != std::errc() || ptr != text.data() + pos + 4)
+        return false;
+
+      pos += 4;
+      out = (char16_t)v;
+      return true;
+    }
+
+    bool parse_string(std::string& out) {
+      pos++; // "
+
+      // \u escapes are collected, to join surrogate pairs.
+      std::u16string units;
+
+      while (pos < text.length()) {
+        char c = text[pos++];
+
+        if (c == '\\' && pos < text.length() && text[pos] == 'u') {
+          char16_t u;
+
+          pos++;
+
+          if (!parse_hex4(u))
+            return false;
+
+          units += u;
+          continue;
+        }
+
+        if (!units.empty()) {
+          utf16_to_utf8_append(out, units.data(), units.length());
+          units.clear();
+        }
+
+        if (c == '"')
+          return true;
+
+        if ((unsigned char)c < 0x20)
+          return false;
+
+        if (c != '\\') {
+          out += c;
+          continue;
+        }
+
+        if (pos >= text.length())
+          return false;
+
+        switch (char e = text[pos++]) {
+          case '"':
+          case '\\':
+          case '/':
+            out += e;
+            break;
+          case 'b':
+            out += '\b';
+            break;
+          case 'f':
+            out += '\f';
+            break;
+          case 'n':
+            out += '\n';
+            break;
+          case 'r':
+            out += '\r';
+            break;
+          case 't':
+            out += '\t';
+            break;
+          default:
+            return false;
+        }
+      }
+
+      return false;
+    }
+
+    bool parse_array(Json& out) {
+      if (++depth > MaxDepth)
+        return false;
+
+      pos++; // [
+      out = Json::array();
+
+      pass_space();
+
+      if (!eat("]")) {
+        do {
+          Json elem;
+
+          if (!parse_value(elem))
+            return false;
+
+          out.push(std::move(elem));
+          pass_space();
+        } while (eat(","));
+
+        if (!eat("]"))
+          return false;
+      }
+
+      depth--;
+      return true;
+    }
+
+    bool parse_object(Json& out) {
+      if (++depth > MaxDepth)
+        return false;
+
+      pos++; // {
+      out = Json::object();
+
+      pass_space();
+
+      if (!eat("}")) {
+        do {
+          std::string key;
+          Json value;
+
+          pass_space();
+
+          if (pos >= text.length() || text[pos] != '"' || !parse_string(key))
+            return false;
+
+          pass_space();
+
+          if (!eat(":") || !parse_value(value))
+            return false;
+
+          out.set(key, std::move(value));
+          pass_space();
+        } while (eat(","));
+
+        if (!eat("}"))
+          return false;
+      }
+
+      depth--;
+      return true;
+    }
+  };
+
+  bool Json::parse(std::string_view text, Json& out) {
+    return JsonParser(text).parse(out);
+  }
+
+} // namespace fire
@@ -0,0 +1,340 @@
+#include <cstdio>
+#include <cstring>
+
+#include "Utils.hpp"
+#include "LanguageServer.hpp"
+
+namespace fire::LSP {
+
+  // JSON-RPC error codes
+  static constexpr int ParseError = -32700;
+  static constexpr int InvalidRequest = -32600;
+  static constexpr int MethodNotFound = -32601;
+  static constexpr int InvalidParams = -32602;
+
+  static Json position_to_json(Position pos) {
+    return Json::object().set("line", pos.line).set("character", pos.character);
+  }
+
+  static Position json_to_position(Json const& j) {
+    return {(size_t)j["line"].as_int(), (size_t)j["character"].as_int()};
+  }
+
+  static Json range_to_json(Position begin, Position end) {
+    return Json::object()
+        .set("start", position_to_json(begin))
+        .set("end", position_to_json(end));
+  }
+
+  Server::Server(int out_fd) : out(out_fd) {
+  }
+
+  int Server::run() {
+    // errors in the compiler must not end the server.
+    set_todo_throws(true);
+
+    std::string body;
+
+    while (read_message(body)) {
+      Json msg;
+
+      if (!Json::parse(body, msg)) {
+        send_error(nullptr, ParseError, "invalid JSON");
+        continue;
+      }
+
+      if (!handle(msg))
+        return is_shutdown ? 0 : 1;
+    }
+
+    // stdin is closed without "exit".
+    return 1;
+  }
+
+  //
+  // "Content-Length: n\r\n" ... "\r\n" and body.
+  bool Server::read_message(std::string& body) {
+    size_t length = 0;
+    bool has_length = false;
+
+    std::string line;
+
+    for (int c; (c = std::fgetc(stdin)) != EOF;) {
+      if (c != '\n') {
+        line += (char)c;
+        continue;
+      }
+
+      if (!line.empty() && line.back() == '\r')
+        line.pop_back();
+
+      if (line.empty()) {
+        if (!has_length)
+          continue;
+
+        body.resize(length);
+        return std::fread(body.data(), 1, length, stdin) == length;
+      }
+
+      if (line.compare(0, 15, "Content-Length:") == 0) {
+        length = std::strtoull(line.c_str() + 15, nullptr, 10);
+        has_length = true;
+      }
+
+      line.clear();
+    }
+
+    return false;
+  }
+
+  void Server::send(Json const& msg) {
+    auto body = msg.dump();
+
+    out.write("Content-Length: ");
+    out.write_int((std::int64_t)body.length());
+    out.write("\r\n\r\n");
+    out.write(body);
+    out.flush();
+  }
+
+  void Server::send_result(Json const& id, Json result) {
+    send(Json::object().set("jsonrpc", "2.0").set("id", id).set("result", std::move(result)));
+  }
+
+  void Server::send_error(Json const& id, int code, std::string const& msg) {
+    send(Json::object()
+             .set("jsonrpc", "2.0")
+             .set("id", id)
+             .set("error", Json::object().set("code", code).set("message", msg)));
+  }
+
+  bool Server::handle(Json const& msg) {
+    auto& method = msg["method"].as_string();
+    auto& id = msg["id"];
+    auto& params = msg["params"];
+
+    // notification if no id.
+    bool is_request = !id.is_null();
+
+    if (method == "exit")
+      return false;
+
+    if (method == "initialize") {
+      send_result(id, on_initialize(params));
+    }
+    else if (method == "shutdown") {
+      is_shutdown = true;
+      send_result(id, nullptr);
+    }
+    else if (is_shutdown) {
+      if (is_request)
+        send_error(id, InvalidRequest, "server is shut down");
+    }
+    else if (method == "textDocument/didOpen") {
+      on_did_open(params);
+    }
+    else if (method == "textDocument/didChange") {
+      on_did_change(params);
+    }
+    else if (method == "textDocument/didClose") {
+      on_did_close(params);
+    }
+    else if (method == "textDocument/hover") {
+      if (get_document(params))
+        send_result(id, on_hover(params));
+      else
+        send_error(id, InvalidParams, "document is not open");
+    }
+    else if (method == "textDocument/definition") {
+      if (get_document(params))
+        send_result(id, on_definition(params));
+      else
+        send_error(id, InvalidParams, "document is not open");
+    }
+    else if (is_request) {
+      send_error(id, MethodNotFound, "unknown method: " + method);
+    }
+
+    return true;
+  }
+
+  Json Server::on_initialize(Json const&) {
+    auto sync = Json::object()
+                    .set("openClose", true)
+                    .set("change", 2); // incremental
+
+    auto caps = Json::object()
+                    .set("textDocumentSync", std::move(sync))
+                    .set("hoverProvider", true)
+                    .set("definitionProvider", true);
+
+    return Json::object()
+        .set("capabilities", std::move(caps))
+        .set("serverInfo", Json::object().set("name", "fire"));
+  }
+
+  void Server::on_did_open(Json const& params) {
+    auto& item = params["textDocument"];
+    auto& uri = item["uri"].as_string();
+
+    auto& doc = documents[uri];
+
+    delete doc;
+    doc = new Document(uri_to_path(uri), item["text"].as_string());
+
+    doc->update();
+    publish_diagnostics(uri, *doc);
+  }
+
+  void Server::on_did_change(Json const& params) {
+    auto& uri = params["textDocument"]["uri"].as_string();
+    auto doc = get_document(params);
+
+    if (!doc)
+      return;
+
+    auto& changes = params["contentChanges"];
+
+    for (size_t i = 0; i < changes.size(); i++) {
+      auto& change = changes[i];
+      auto& range = change["range"];
+
+      if (range.is_null()) {
+        doc->edit(0, doc->get_text().length(), change["text"].as_string());
+        continue;
+      }
+
+      size_t begin = doc->to_offset(json_to_position(range["start"]));
+      size_t end = doc->to_offset(json_to_position(range["end"]));
+
+      doc->edit(begin, end, change["text"].as_string());
+    }
+
+    doc->update();
+    publish_diagnostics(uri, *doc);
+  }
+
+  void Server::on_did_close(Json const& params) {
+    auto& uri = params["textDocument"]["uri"].as_string();
+
+    if (auto it = documents.find(uri); it != documents.end()) {
+      delete it->second;
+      documents.erase(it);
+    }
+
+    // clear diagnostics of the file.
+    send(Json::object()
+             .set("jsonrpc", "2.0")
+             .set("method", "textDocument/publishDiagnostics")
+             .set("params", Json::object().set("uri", uri).set("diagnostics", Json::array())));
+  }
+
+  Json Server::on_hover(Json const& params) {
+    auto doc = get_document(params);
+    size_t offset = doc->to_offset(json_to_position(params["position"]));
+
+    size_t begin = 0, end = 0;
+    auto text = doc->get_hover(offset, begin, end);
+
+    if (text.empty())
+      return nullptr;
+
+    auto contents = Json::object()
+                        .set("kind", "markdown")
+                        .set("value", "```fire\n" + text + "\n```");
+
+    return Json::object()
+        .set("contents", std::move(contents))
+        .set("range", range_to_json(doc->to_position(begin), doc->to_position(end)));
+  }
+
+  Json Server::on_definition(Json const& params) {
+    auto doc = get_document(params);
+    size_t offset = doc->to_offset(json_to_position(params["position"]));
+
+    Location loc;
+
+    if (!doc->get_definition(offset, loc))
+      return nullptr;
+
+    return Json::object()
+        .set("uri", path_to_uri(loc.path))
+        .set("range", range_to_json(loc.begin, loc.end));
+  }
+
+  void Server::publish_diagnostics(std::string const& uri, Document& doc) {
+    auto list = Json::array();
+
+    for (auto& d : doc.get_diagnostics()) {
+      list.push(Json::object()
+                    .set("range", range_to_json(doc.to_position(d.begin), doc.to_position(d.end)))
+                    .set("severity", d.is_warn ? 2 : 1)
+                    .set("source", "fire")
+                    .set("message", d.message));
+    }
+
+    send(Json::object()
+             .set("jsonrpc", "2.0")
+             .set("method", "textDocument/publishDiagnostics")
+             .set("params", Json::object().set("uri", uri).set("diagnostics", std::move(list))));
+  }
+
+  Document* Server::get_document(Json const& params) {
+    auto it = documents.find(params["textDocument"]["uri"].as_string());
+
+    return it == documents.end() ? nullptr : it->second;
+  }
+
+  static int hex_value(char c) {
+    if ('0' <= c && c <= '9')
+      return c - '0';
+
+    if ('a' <= (c | 0x20) && (c | 0x20) <= 'f')
+      return (c | 0x20) - 'a' + 10;
+
+    return -1;
+  }
+
+  std::string uri_to_path(std::string_view uri) {
+    if (uri.substr(0, 7) == "file://")
+      uri.remove_prefix(7);
+
+    std::string path;
+
+    for (size_t i = 0; i < uri.length(); i++) {
+      if (uri[i] == '%' && i + 2 < uri.length()) {
+        int hi = hex_value(uri[i + 1]), lo = hex_value(uri[i + 2]);
+
+        if (hi >= 0 && lo >= 0) {
+          path += (char)(hi * 16 + lo);
+          i += 2;
+          continue;
+        }
+      }
+
+      path += uri[i];
+    }
+
+    return path;
+  }
+
+  std::string path_to_uri(std::string_view path) {
+    static char const digits[] = "0123456789ABCDEF";
+
+    std::string uri = "file://";
+
+    for (unsigned char c : path) {
+      if (std::isalnum(c) || std::strchr("/-._~", c)) {
+        uri += (char)c;
+        continue;
+      }
+
+      uri += '%';
+      uri += digits[c >> 4];
+      uri += digits[c & 15];
+    }
+
+    return uri;
+  }
+
+} // namespace fire::LSP
@@ -0,0 +1,988 @@
+#include <algorithm>
+#include <filesystem>
+#include <unordered_set>
+
+#include "Utils.hpp"
+#include "Error.hpp"
+#include "Lexer.hpp"
+#include "Parser.hpp"
+#include "Sema.hpp"
+#include "strconv.hpp"
+#include "LanguageServer.hpp"
+
+namespace fire::LSP {
+
+  static constexpr size_t npos = static_cast<size_t>(-1);
+
+  static size_t end_of(Token const* tok) {
+    return tok->pos + tok->text.length();
+  }
+
+  //
+  // calls fn for each child of the node.
+  template <typename F>
+  static void for_each_child(Node* node, F&& fn) {
+    auto call = [&fn](Node* x) {
+      if (x)
+        fn(x);
+    };
+
+    auto each = [&call](auto const& v) {
+      for (auto x : v)
+        call(x);
+    };
+
+    switch (node->kind) {
+      case NodeKind::Symbol: {
+        auto sym = node->as<NdSymbol>();
+        call(sym->dec);
+        each(sym->te_args);
+        call(sym->next);
+        call(sym->concept_nd);
+        break;
+      }
+
+      case NodeKind::DeclType:
+        call(node->as<NdDeclType>()->expr);
+        break;
+
+      case NodeKind::KeyValuePair:
+        call(node->as<NdKeyValuePair>()->key);
+        call(node->as<NdKeyValuePair>()->value);
+        break;
+
+      case NodeKind::Array:
+        each(node->as<NdArray>()->data);
+        break;
+
+      case NodeKind::Tuple:
+        each(node->as<NdTuple>()->elems);
+        break;
+
+      case NodeKind::CallFunc: {
+        auto x = node->as<NdCallFunc>();
+        if (x->is_method_call)
+          call(x->inst_expr);
+        call(x->callee);
+        each(x->args);
+        break;
+      }
+
+      case NodeKind::GetTupleElement:
+        call(node->as<NdGetTupleElement>()->expr);
+        break;
+
+      case NodeKind::Inclement:
+        call(node->as<NdInclement>()->expr);
+        break;
+
+      case NodeKind::Declement:
+        call(node->as<NdDeclement>()->expr);
+        break;
+
+      case NodeKind::New:
+        call(node->as<NdNew>()->type);
+        each(node->as<NdNew>()->args);
+        break;
+
+      case NodeKind::Ref:
+        call(node->as<NdRef>()->expr);
+        break;
+
+      case NodeKind::Deref:
+        call(node->as<NdDeref>()->expr);
+        break;
+
+      case NodeKind::BitNot:
+        call(node->as<NdBitNot>()->expr);
+        break;
+
+      // "!a" is NdNot, and "a != b" is NdExpr.
+      case NodeKind::Not:
+        if (auto x = dynamic_cast<NdNot*>(node); x) {
+          call(x->expr);
+          break;
+        }
+        [[fallthrough]];
+
+      case NodeKind::Slice:
+      case NodeKind::Subscript:
+      case NodeKind::MemberAccess:
+      case NodeKind::Mul:
+      case NodeKind::Div:
+      case NodeKind::Mod:
+      case NodeKind::Add:
+      case NodeKind::Sub:
+      case NodeKind::LShift:
+      case NodeKind::RShift:
+      case NodeKind::Bigger:
+      case NodeKind::BiggerOrEqual:
+      case NodeKind::Equal:
+      case NodeKind::BitAnd:
+      case NodeKind::BitXor:
+      case NodeKind::BitOr:
+      case NodeKind::LogAnd:
+      case NodeKind::LogOr:
+      case NodeKind::Assign:
+        call(node->as<NdExpr>()->lhs);
+        call(node->as<NdExpr>()->rhs);
+        break;
+
+      case NodeKind::AssignWithOp:
+        call(node->as<NdAssignWithOp>()->lhs);
+        call(node->as<NdAssignWithOp>()->rhs);
+        break;
+
+      case NodeKind::Scope:
+        each(node->as<NdScope>()->items);
+        break;
+
+      case NodeKind::Let:
+        call(node->as<NdLet>()->type);
+        call(node->as<NdLet>()->init);
+        break;
+
+      case NodeKind::Try: {
+        auto x = node->as<NdTry>();
+        call(x->body);
+        each(x->catches);
+        call(x->finally_block);
+        break;
+      }
+
+      case NodeKind::Catch:
+        call(node->as<NdCatch>()->error_type);
+        call(node->as<NdCatch>()->body);
+        break;
+
+      case NodeKind::If: {
+        auto x = node->as<NdIf>();
+        call(x->vardef);
+        call(x->cond);
+        call(x->thencode);
+        call(x->elsecode);
+        break;
+      }
+
+      case NodeKind::For:
+        call(node->as<NdFor>()->iterable);
+        call(node->as<NdFor>()->body);
+        break;
+
+      case NodeKind::While: {
+        auto x = node->as<NdWhile>();
+        call(x->vardef);
+        call(x->cond);
+        call(x->body);
+        break;
+      }
+
+      case NodeKind::Return:
+        call(node->as<NdReturn>()->expr);
+        break;
+
+      case NodeKind::FuncArgument:
+        call(static_cast<NdFunction::Argument*>(node)->type);
+        break;
+
+      case NodeKind::Function: {
+        auto x = node->as<NdFunction>();
+        each(x->parameter_defs);
+        for (auto& arg : x->args)
+          call(&arg);
+        call(x->result_type);
+        call(x->body);
+        break;
+      }
+
+      case NodeKind::Class: {
+        auto x = node->as<NdClass>();
+        each(x->parameter_defs);
+        call(x->base_class);
+        each(x->fields);
+        each(x->methods);
+        call(x->m_new);
+        break;
+      }
+
+      case NodeKind::Enum:
+        each(node->as<NdEnum>()->enumerators);
+        break;
+
+      case NodeKind::EnumeratorDef:
+        call(node->as<NdEnumeratorDef>()->variant);
+        each(node->as<NdEnumeratorDef>()->multiple);
+        break;
+
+      case NodeKind::Namespace:
+        each(node->as<NdNamespace>()->items);
+        break;
+
+      case NodeKind::Module:
+        each(node->as<NdModule>()->items);
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  //
+  // name of declaration, or the token of node.
+  static Token const& get_name_token(Node* node) {
+    switch (node->kind) {
+      case NodeKind::Symbol:
+        return node->as<NdSymbol>()->name;
+      case NodeKind::Let:
+        return node->as<NdLet>()->name;
+      case NodeKind::FuncArgument:
+        return static_cast<NdFunction::Argument*>(node)->name;
+      case NodeKind::Function:
+        return node->as<NdFunction>()->name;
+      case NodeKind::Class:
+        return node->as<NdClass>()->name;
+      case NodeKind::Enum:
+        return node->as<NdEnum>()->name;
+      case NodeKind::EnumeratorDef:
+        return node->as<NdEnumeratorDef>()->name;
+      case NodeKind::For:
+        return node->as<NdFor>()->iter;
+      case NodeKind::Catch:
+        return node->as<NdCatch>()->holder;
+      default:
+        return node->token;
+    }
+  }
+
+  // node named by the token. (first one in pre-order)
+  static Node* find_node(Node* node, Token const& tok) {
+    if (node->kind != NodeKind::DeclType) {
+      auto& name = get_name_token(node);
+
+      if (name.source == tok.source && name.pos == tok.pos)
+        return node;
+    }
+
+    Node* found = nullptr;
+
+    for_each_child(node, [&](Node* x) {
+      if (!found)
+        found = find_node(x, tok);
+    });
+
+    // "a::b" is resolved in the first symbol.
+    if (node->is(NodeKind::Symbol) && found && found != node && found->is(NodeKind::Symbol)) {
+      auto sym = found->as<NdSymbol>();
+
+      if (!sym->symbol_ptr && !sym->sym_target) {
+        for (auto x = node->as<NdSymbol>()->next; x; x = x->next) {
+          if (x == found)
+            return node;
+        }
+      }
+    }
+
+    // name of method is resolved in the call.
+    if (node->is(NodeKind::CallFunc)) {
+      auto call = node->as<NdCallFunc>();
+
+      if (found == call->callee && call->is_method_call && call->func_nd)
+        return call;
+    }
+
+    return found;
+  }
+
+  static std::string get_signature(NdFunction* fn) {
+    std::string s = "fn " + std::string(fn->name.text) + "(";
+
+    if (fn->take_self)
+      s += fn->args.empty() ? "self" : "self, ";
+
+    s += join(", ", fn->args, [](NdFunction::Argument const& a) {
+      return std::string(a.name.text) + ": " + node2s(a.type);
+    });
+
+    s += ")";
+
+    if (fn->result_type)
+      s += " -> " + node2s(fn->result_type);
+
+    return s;
+  }
+
+  static std::string get_var_text(std::string_view name, VariableInfo const* info,
+                                  NdSymbol* type) {
+    if (info && info->is_type_deducted)
+      return "var " + std::string(name) + ": " + info->type.to_string();
+
+    if (type)
+      return "var " + std::string(name) + ": " + node2s(type);
+
+    return "var " + std::string(name);
+  }
+
+  // text to show for declaration.
+  static std::string get_decl_text(Node* node) {
+    switch (node->kind) {
+      case NodeKind::Let: {
+        auto let = node->as<NdLet>();
+        auto info = let->symbol_ptr ? let->symbol_ptr->var_info : nullptr;
+        return get_var_text(let->name.text, info, let->type);
+      }
+
+      case NodeKind::FuncArgument: {
+        auto arg = static_cast<NdFunction::Argument*>(node);
+        return get_var_text(arg->name.text, arg->var_info_ptr, arg->type);
+      }
+
+      case NodeKind::Function:
+        return get_signature(node->as<NdFunction>());
+
+      case NodeKind::Class:
+        return "class " + std::string(node->as<NdClass>()->name.text);
+
+      case NodeKind::Enum:
+        return "enum " + std::string(node->as<NdEnum>()->name.text);
+
+      case NodeKind::EnumeratorDef:
+        return node->as<NdEnumeratorDef>()->get_full_name();
+
+      case NodeKind::Namespace:
+        return "namespace " + node->as<NdNamespace>()->name;
+
+      default:
+        return "";
+    }
+  }
+
+  static std::string get_hover_text(Node* node) {
+    if (node->is(NodeKind::CallFunc))
+      return get_signature(node->as<NdCallFunc>()->func_nd);
+
+    if (node->is(NodeKind::Symbol)) {
+      auto sym = node->as<NdSymbol>();
+
+      if (auto s = sym->symbol_ptr; s) {
+        switch (s->kind) {
+          case SymbolKind::Var:
+            if (s->node)
+              return get_decl_text(s->node);
+            return get_var_text(s->name, s->var_info, nullptr);
+
+          case SymbolKind::BuiltinFunc:
+          case SymbolKind::BuiltinType:
+            return s->name + ": " + s->type.to_string();
+
+          default:
+            if (s->node)
+              return get_decl_text(s->node);
+        }
+      }
+
+      if (sym->sym_target)
+        return get_decl_text(sym->sym_target);
+    }
+
+    if (auto s = get_decl_text(node); !s.empty())
+      return s;
+
+    if (node->ty_evaluated)
+      return node->ty.to_string();
+
+    return "";
+  }
+
+  // token of declaration referred by the node.
+  static Token const* get_declaration(Node* node) {
+    if (node->is(NodeKind::CallFunc))
+      return &node->as<NdCallFunc>()->func_nd->name;
+
+    if (node->is(NodeKind::Symbol)) {
+      auto sym = node->as<NdSymbol>();
+
+      if (auto s = sym->symbol_ptr; s) {
+        if (s->node)
+          return &get_name_token(s->node);
+        return s->token;
+      }
+
+      if (sym->sym_target)
+        return &get_name_token(sym->sym_target);
+
+      return nullptr;
+    }
+
+    if (get_decl_text(node).empty())
+      return nullptr;
+
+    return &get_name_token(node);
+  }
+
+  // position of token in a file not opened.
+  static Position get_position(Token const& tok) {
+    auto& data = tok.source->data;
+    size_t begin = tok.pos;
+
+    while (begin > 0 && data[begin - 1] != '\n')
+      begin--;
+
+    return {tok.line - 1, utf8_to_utf16_length(data.data() + begin, tok.pos - begin)};
+  }
+
+  Document::Document(std::string path, std::string text)
+      : path(std::move(path)), text(std::move(text)), pool(new ConstantPool()),
+        sema(Sema::create()) {
+    line_starts.push_back(0);
+
+    for (size_t i = 0; i < this->text.length(); i++) {
+      if (this->text[i] == '\n')
+        line_starts.push_back(i + 1);
+    }
+  }
+
+  void Document::edit(size_t begin, size_t end, std::string_view str) {
+    begin = std::min(begin, text.length());
+    end = std::clamp(end, begin, text.length());
+
+    ptrdiff_t delta = (ptrdiff_t)str.length() - (ptrdiff_t)(end - begin);
+
+    // starts of lines after newlines in [begin, end) are removed.
+    auto first = std::upper_bound(line_starts.begin(), line_starts.end(), begin);
+    auto last = std::upper_bound(first, line_starts.end(), end);
+
+    for (auto it = last; it != line_starts.end(); it++)
+      *it += delta;
+
+    std::vector<size_t> added;
+
+    for (size_t i = 0; i < str.length(); i++) {
+      if (str[i] == '\n')
+        added.push_back(begin + i + 1);
+    }
+
+    line_starts.insert(line_starts.erase(first, last), added.begin(), added.end());
+
+    text.replace(begin, end - begin, str);
+  }
+
+  size_t Document::get_line(size_t offset) const {
+    return std::upper_bound(line_starts.begin(), line_starts.end(), offset) -
+           line_starts.begin() - 1;
+  }
+
+  size_t Document::to_offset(Position pos) const {
+    if (pos.line >= line_starts.size())
+      return text.length();
+
+    size_t i = line_starts[pos.line];
+
+    for (size_t n = 0; n < pos.character && i < text.length() && text[i] != '\n';) {
+      auto c = (unsigned char)text[i];
+      size_t len = c < 0xC0 ? 1 : c < 0xE0 ? 2 : c < 0xF0 ? 3 : 4;
+
+      n += len == 4 ? 2 : 1; // surrogate pair
+      i += len;
+    }
+
+    return std::min(i, text.length());
+  }
+
+  Position Document::to_position(size_t offset) const {
+    offset = std::min(offset, text.length());
+
+    size_t line = get_line(offset);
+    size_t begin = line_starts[line];
+
+    return {line, utf8_to_utf16_length(text.data() + begin, offset - begin)};
+  }
+
+  void Document::update() {
+    SourceFile::set_registry(&registry);
+
+    auto prev = file;
+
+    file = new SourceFile(path, text);
+
+    // imports are relative to the folder. (same as Driver)
+    if (auto folder = file->get_folder(); !folder.empty()) {
+      std::error_code ec;
+      std::filesystem::current_path(folder, ec);
+    }
+
+    diagnostics.clear();
+    parse_failed = false;
+    reparsed_count = 0;
+
+    try {
+      if (need_full || !prev || !reparse_changed(prev))
+        reparse_full();
+
+      if (!parse_failed)
+        analyze();
+    }
+    catch (err::e& e) {
+      add_diagnostic(e);
+    }
+    catch (todo_error&) {
+      // not implemented in the compiler yet.
+    }
+
+    SourceFile::set_registry(nullptr);
+
+    if (prev)
+      versions.push_back(prev);
+
+    release_versions();
+  }
+
+  void Document::reparse_full() {
+    // whole text is an error until parsed.
+    items = {Item{.begin = 0, .end = text.length()}};
+    header_end = 0;
+    need_full = true;
+    parse_failed = true;
+
+    // items of imported files are merged again.
+    for (auto& [_, src] : registry)
+      src->is_node_imported = false;
+
+    Token* tok = file->lex();
+
+    for (Token* t = tok; t->text == "import"; t = t->next) {
+      while (!t->is(TokenKind::Eof) && t->text != ";")
+        t = t->next;
+
+      if (t->is(TokenKind::Eof))
+        break;
+
+      header_end = end_of(t);
+    }
+
+    auto parsed = Parser(*file, tok, pool).ps_mod();
+
+    std::vector<Node*> own;
+    std::unordered_map<SourceFile const*, std::vector<Node*>> imports;
+
+    for (auto item : parsed->items) {
+      if (item->token.source == file)
+        own.emplace_back(item);
+      else
+        imports[item->token.source].emplace_back(item);
+    }
+
+    //
+    // keep items of files imported already, since they may be analyzed ones.
+    std::vector<Node*> new_imported;
+
+    for (auto item : imported) {
+      if (auto it = imports.find(item->token.source); it != imports.end())
+        new_imported.push_back(item);
+    }
+
+    for (auto item : parsed->items) {
+      if (item->token.source == file)
+        continue;
+
+      if (std::none_of(imported.begin(), imported.end(), [item](Node* x) {
+            return x->token.source == item->token.source;
+          }))
+        new_imported.push_back(item);
+    }
+
+    imported = std::move(new_imported);
+
+    //
+    // namespaces split into blocks.
+    std::unordered_set<std::string_view> names;
+
+    need_full = false;
+
+    for (auto item : own) {
+      if (item->is(NodeKind::Namespace) && !names.emplace(item->as<NdNamespace>()->name).second)
+        need_full = true;
+    }
+
+    if (need_full)
+      Parser::merge_namespaces(own);
+
+    items.clear();
+
+    for (auto item : own) {
+      items.push_back({
+          .node = item,
+          .first = &item->token,
+          .last = item->end_token,
+          .begin = item->token.pos,
+          .end = end_of(item->end_token),
+      });
+    }
+
+    reparsed_count = own.size();
+    parse_failed = false;
+  }
+
+  bool Document::reparse_changed(SourceFile const* prev) {
+    auto& old_data = prev->data;
+    auto& new_data = file->data;
+
+    size_t max = std::min(old_data.length(), new_data.length());
+
+    // changed range: [a, old_end) -> [a, new_end)
+    size_t a = std::mismatch(old_data.begin(), old_data.begin() + max, new_data.begin()).first -
+               old_data.begin();
+
+    size_t s = std::mismatch(old_data.rbegin(), old_data.rbegin() + (max - a),
+                             new_data.rbegin()).first -
+               old_data.rbegin();
+
+    size_t old_end = old_data.length() - s;
+    ptrdiff_t delta = (ptrdiff_t)new_data.length() - (ptrdiff_t)old_data.length();
+
+    // imports are changed.
+    if (header_end > 0 && a <= header_end)
+      return false;
+
+    //
+    // items [i0, i1) touch the change.
+    // items with errors are parsed again together.
+    size_t i0 = std::partition_point(items.begin(), items.end(),
+                                     [a](Item const& x) { return x.end < a; }) -
+                items.begin();
+
+    size_t i1 = std::partition_point(items.begin() + i0, items.end(),
+                                     [old_end](Item const& x) { return x.begin <= old_end; }) -
+                items.begin();
+
+    for (size_t i = 0; i < items.size(); i++) {
+      if (!items[i].node) {
+        i0 = std::min(i0, i);
+        i1 = std::max(i1, i + 1);
+      }
+    }
+
+    size_t begin = i0 > 0 ? items[i0 - 1].end : header_end;
+    size_t end = i1 < items.size() ? items[i1].begin + delta : new_data.length();
+
+    Lexer lexer(file, begin, end, get_line(begin) + 1);
+    Token* tok;
+
+    try {
+      tok = lexer.lex();
+    }
+    catch (err::e&) {
+      return false;
+    }
+
+    // a comment or a literal continues to next items.
+    if (end < new_data.length() && !lexer.is_clean_end())
+      return false;
+
+    if (tok->text == "import")
+      return false;
+
+    std::vector<Item> new_items;
+
+    try {
+      for (auto node : Parser(*file, tok, pool).ps_items()) {
+        new_items.push_back({
+            .node = node,
+            .first = &node->token,
+            .last = node->end_token,
+            .begin = node->token.pos,
+            .end = end_of(node->end_token),
+        });
+      }
+    }
+    catch (err::e& e) {
+      new_items = {Item{.begin = begin, .end = end}};
+      parse_failed = true;
+      add_diagnostic(e);
+    }
+    catch (todo_error&) {
+      new_items = {Item{.begin = begin, .end = end}};
+      parse_failed = true;
+    }
+
+    //
+    // a namespace of same name as another block is merged.
+    std::unordered_set<std::string_view> names;
+
+    for (size_t i = 0; i < items.size(); i++) {
+      if ((i < i0 || i >= i1) && items[i].node && items[i].node->is(NodeKind::Namespace))
+        names.emplace(items[i].node->as<NdNamespace>()->name);
+    }
+
+    for (auto& item : new_items) {
+      if (item.node && item.node->is(NodeKind::Namespace) &&
+          !names.emplace(item.node->as<NdNamespace>()->name).second)
+        return false;
+    }
+
+    for (size_t i = i1; i < items.size(); i++) {
+      items[i].begin += delta;
+      items[i].end += delta;
+    }
+
+    reparsed_count = parse_failed ? 0 : new_items.size();
+
+    items.erase(items.begin() + i0, items.begin() + i1);
+    items.insert(items.begin() + i0, new_items.begin(), new_items.end());
+
+    return true;
+  }
+
+  Node* Document::reparse_item(SourceFile const* src, size_t begin, size_t end, size_t line) {
+    auto items = Parser(*const_cast<SourceFile*>(src), Lexer(src, begin, end, line).lex(), pool)
+                     .ps_items();
+
+    assert(items.size() == 1);
+    reparsed_count++;
+
+    return items[0];
+  }
+
+  void Document::analyze() {
+    std::vector<Node*> list = imported;
+
+    for (auto& item : items)
+      list.push_back(item.node);
+
+    Parser::reorder_items(list);
+
+    //
+    // nodes analyzed already can't be checked again.
+    // replace them with newly parsed ones.
+    for (auto node : sema->get_stale_items(list)) {
+      Node* fresh = nullptr;
+
+      if (auto it = std::find_if(items.begin(), items.end(),
+                                 [node](Item const& x) { return x.node == node; });
+          it != items.end()) {
+        fresh = reparse_item(file, it->begin, it->end, get_line(it->begin) + 1);
+
+        *it = {
+            .node = fresh,
+            .first = &fresh->token,
+            .last = fresh->end_token,
+            .begin = it->begin,
+            .end = it->end,
+        };
+      } else {
+        auto& tok = node->token;
+
+        fresh = reparse_item(tok.source, tok.pos, end_of(node->end_token), tok.line);
+
+        std::replace(imported.begin(), imported.end(), node, fresh);
+      }
+
+      std::replace(list.begin(), list.end(), node, fresh);
+    }
+
+    Token tok(TokenKind::Eof);
+    tok.source = file;
+
+    mod = new NdModule(tok);
+    mod->name = "__main__";
+    mod->constants = pool;
+    mod->items = list;
+
+    for (auto& item : items) {
+      if (!item.node->is(NodeKind::Function))
+        continue;
+
+      if (auto f = item.node->as<NdFunction>(); f->name.text == "main") {
+        if (mod->main_fn)
+          throw err::duplicate_of_definition(f->name, mod->main_fn->name);
+
+        mod->main_fn = f;
+      }
+    }
+
+    //
+    // clean items are taken over from previous analysis by Sema.
+    // the items keep tokens of new text, to map positions.
+    auto take_over = [this, &list] {
+      std::unordered_map<Node*, Node*> taken;
+
+      for (size_t i = 0; i < list.size(); i++) {
+        if (list[i] != mod->items[i])
+          taken[list[i]] = mod->items[i];
+      }
+
+      for (auto& item : items) {
+        if (auto it = taken.find(item.node); it != taken.end())
+          item.node = it->second;
+      }
+
+      for (auto& item : imported) {
+        if (auto it = taken.find(item); it != taken.end())
+          item = it->second;
+      }
+    };
+
+    try {
+      sema->reanalyze(mod);
+    }
+    catch (...) {
+      take_over();
+      throw;
+    }
+
+    take_over();
+  }
+
+  //
+  // delete old versions which no items refer to.
+  void Document::release_versions() {
+    std::unordered_set<SourceFile const*> used;
+
+    for (auto& item : items) {
+      if (item.node) {
+        used.insert(item.node->token.source);
+        used.insert(item.first->source);
+      }
+    }
+
+    // last analyzed module. (kept in Sema)
+    if (mod) {
+      for (auto item : mod->items)
+        used.insert(item->token.source);
+    }
+
+    auto it = std::remove_if(versions.begin(), versions.end(), [&used](SourceFile* src) {
+      if (used.count(src))
+        return false;
+
+      delete src;
+      return true;
+    });
+
+    versions.erase(it, versions.end());
+  }
+
+  void Document::add_diagnostic(err::e const& e) {
+    size_t begin = map_pos(&e.s, e.pos);
+
+    if (begin == npos) {
+      diagnostics.push_back({
+          .message = format("%s:%zu:%zu: ", e.s.path.c_str(), e.line, e.column) + e.msg,
+          .is_warn = e.is_warn,
+      });
+
+      return;
+    }
+
+    diagnostics.push_back({
+        .begin = begin,
+        .end = std::min(begin + e.len, text.length()),
+        .message = e.msg,
+        .is_warn = e.is_warn,
+    });
+  }
+
+  Document::Item const* Document::find_item(size_t offset) const {
+    auto it = std::partition_point(items.begin(), items.end(),
+                                   [offset](Item const& x) { return x.end <= offset; });
+
+    if (it == items.end() || offset < it->begin || !it->node)
+      return nullptr;
+
+    return &*it;
+  }
+
+  Token const* Document::find_token(Item const& item, size_t offset) const {
+    size_t delta = item.begin - item.first->pos;
+    Token const* n = &item.node->token;
+
+    for (Token const* t = item.first; t && n; t = t->next, n = n->next) {
+      size_t begin = t->pos + delta;
+
+      if (offset < begin)
+        break;
+
+      if (offset < begin + t->text.length())
+        return n;
+
+      if (t == item.last)
+        break;
+    }
+
+    return nullptr;
+  }
+
+  size_t Document::map_pos(SourceFile const* src, size_t pos) const {
+    if (src == file)
+      return pos;
+
+    for (auto& item : items) {
+      if (!item.node)
+        continue;
+
+      auto first = &item.node->token;
+
+      if (first->source != src || pos < first->pos || pos > item.node->end_token->pos)
+        continue;
+
+      // same index in the tokens of latest lexing.
+      Token const* t = item.first;
+
+      for (Token const* n = first; n && t; n = n->next, t = t->next) {
+        if (n->pos == pos)
+          return t->pos + (item.begin - item.first->pos);
+
+        if (n == item.node->end_token)
+          break;
+      }
+    }
+
+    return npos;
+  }
+
+  std::string Document::get_hover(size_t offset, size_t& begin, size_t& end) {
+    auto item = find_item(offset);
+
+    if (!item)
+      return "";
+
+    auto tok = find_token(*item, offset);
+    auto node = tok ? find_node(item->node, *tok) : nullptr;
+
+    if (!node)
+      return "";
+
+    begin = map_pos(tok->source, tok->pos);
+    end = begin + tok->text.length();
+
+    return get_hover_text(node);
+  }
+
+  bool Document::get_definition(size_t offset, Location& loc) {
+    auto item = find_item(offset);
+
+    if (!item)
+      return false;
+
+    auto tok = find_token(*item, offset);
+    auto node = tok ? find_node(item->node, *tok) : nullptr;
+    auto decl = node ? get_declaration(node) : nullptr;
+
+    if (!decl || !decl->source)
+      return false;
+
+    if (size_t pos = map_pos(decl->source, decl->pos); pos != npos) {
+      loc.path = path;
+      loc.begin = to_position(pos);
+      loc.end = to_position(pos + decl->text.length());
+      return true;
+    }
+
+    // in an imported file.
+    loc.path = decl->source->path;
+    loc.begin = get_position(*decl);
+    loc.end = {loc.begin.line, loc.begin.character + decl->text.length()};
+
+    return true;
+  }
+
+} // namespace fire::LSP
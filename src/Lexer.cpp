@@ -1,3 +1,6 @@
+#include <charconv>
+#include <cstdint>
+
 #include "Utils.hpp"
 #include "Error.hpp"
 
@@ -21,20 +24,14 @@ namespace fire {
     Token head;
     Token* cur = &head;
 
-    pass_space();
-
-    while (!is_end()) {
-      while(match("//")) { pass_line_comment(); }
-      while(match("/*")) { pass_block_comment(); }  
-      pass_space();
+    for (pass_space_and_comments(); !is_end(); pass_space_and_comments())
       cur = tokenize(peek(), cur);
-    }
 
     cur->next = new Token(TokenKind::Eof, std::string_view(), cur, _source, _pos);
 
-    size_t i = 0, line = 1, col = 1;
+    size_t i = _begin, line = _line, col = get_first_column();
 
-    for (Token* t = head.next; (t = t->next);) {
+    for (Token* t = head.next; t; t = t->next) {
       for (; i < t->pos; i++, col++)
         if (get_char(i) == '\n') line++, col = 0;
       t->line = line;
@@ -44,6 +41,261 @@ namespace fire {
     return head.next;
   }
 
+  void Lexer::locate(Token* tok) {
+    tok->line = _line;
+    tok->column = get_first_column();
+
+    for (size_t i = _begin; i < tok->pos; i++, tok->column++)
+      if (get_char(i) == '\n')
+        tok->line++, tok->column = 0;
+  }
+
+  size_t Lexer::get_first_column() const {
+    size_t col = 1;
+
+    for (size_t i = _begin; i > 0 && get_char(i - 1) != '\n'; i--)
+      col++;
+
+    return col;
+  }
+
+  //
+  // int:   [0-9][0-9_]* | 0x[0-9a-fA-F_]+ | 0b[01_]+
+  // float: [0-9][0-9_]* "." [0-9_]* ([eE][+-]?[0-9]+)? "f"?
+  //
+  // the value is parsed here with std::from_chars. (locale independent)
+  void Lexer::lex_number(Token* tok) {
+    char const* data = _source->data.data();
+    size_t begin = _pos;
+    int base = 10;
+
+    if (peek() == '0' && _pos + 1 < _len) {
+      switch (get_char(_pos + 1)) {
+        case 'x':
+        case 'X':
+          base = 16;
+          break;
+        case 'b':
+        case 'B':
+          base = 2;
+          break;
+      }
+
+      if (base != 10)
+        _pos += 2;
+    }
+
+    auto is_digit = [base](char c) {
+      return base == 16 ? std::isxdigit(c) : base == 2 ? c == '0' || c == '1' : std::isdigit(c);
+    };
+
+    size_t digits = _pos;
+    bool has_sep = false;
+
+    while (!is_end() && (is_digit(peek()) || peek() == '_'))
+      has_sep |= peek() == '_', _pos++;
+
+    if (base == 10 && !is_end() && peek() == '.') {
+      tok->kind = TokenKind::Float;
+      _pos++;
+
+      while (!is_end() && (std::isdigit(peek()) || peek() == '_'))
+        has_sep |= peek() == '_', _pos++;
+
+      // exponent (only if digits follow)
+      if (!is_end() && (peek() == 'e' || peek() == 'E')) {
+        size_t e = _pos + 1;
+
+        if (e < _len && (get_char(e) == '+' || get_char(e) == '-'))
+          e++;
+
+        if (e < _len && std::isdigit(get_char(e))) {
+          _pos = e;
+
+          while (!is_end() && std::isdigit(peek()))
+            _pos++;
+        }
+      }
+    }
+
+    size_t end = _pos;
+
+    if (tok->kind == TokenKind::Float && !is_end() && peek() == 'f')
+      _pos++;
+
+    tok->text = std::string_view(data + begin, _pos - begin);
+
+    std::string_view str(data + digits, end - digits);
+    std::string tmp;
+
+    if (has_sep) {
+      for (char c : str)
+        if (c != '_')
+          tmp += c;
+
+      str = tmp;
+    }
+
+    auto error = [&](std::string const& msg) {
+      locate(tok);
+      throw err::invalid_number_literal(*tok, msg);
+    };
+
+    if (str.empty())
+      error("expected digits after '" + std::string(tok->text) + "'");
+
+    if (tok->kind == TokenKind::Float) {
+      auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.length(), tok->float_value);
+
+      if (ec != std::errc() || ptr != str.data() + str.length())
+        error("invalid float literal");
+
+      return;
+    }
+
+    std::uint64_t value = 0;
+    auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.length(), value, base);
+
+    // hex and binary literals can have all 64 bits.
+    if (ec != std::errc() || ptr != str.data() + str.length() ||
+        (base == 10 && value > (std::uint64_t)INT64_MAX))
+      error("integer literal is too large");
+
+    tok->int_value = (std::int64_t)value;
+  }
+
+  static void append_utf8(std::string& s, uint32_t cp) {
+    if (cp < 0x80) {
+      s += (char)cp;
+    } else if (cp < 0x800) {
+      s += (char)(0xC0 | (cp >> 6));
+      s += (char)(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+      s += (char)(0xE0 | (cp >> 12));
+      s += (char)(0x80 | ((cp >> 6) & 0x3F));
+      s += (char)(0x80 | (cp & 0x3F));
+    } else {
+      s += (char)(0xF0 | (cp >> 18));
+      s += (char)(0x80 | ((cp >> 12) & 0x3F));
+      s += (char)(0x80 | ((cp >> 6) & 0x3F));
+      s += (char)(0x80 | (cp & 0x3F));
+    }
+  }
+
+  //
+  // string or char literal.
+  //   text is the literal in the source (with quotes).
+  //   str_value is the content; a slice of the source if no escapes, or
+  //   decoded into the string arena of the source.
+  //
+  //   escapes: \0 \t \r \n \b \\ \" \' \xHH \u{H..H}
+  void Lexer::lex_string(Token* tok, char quote) {
+    char const* data = _source->data.data();
+    size_t begin = _pos++;
+
+    auto error = [&](std::string const& msg) {
+      tok->text = std::string_view(data + begin, _pos - begin);
+      locate(tok);
+      throw err::invalid_string_literal(*tok, msg);
+    };
+
+    // fast path: no escapes.
+    size_t content = _pos;
+
+    while (!is_end() && peek() != quote && peek() != '\\')
+      _pos++;
+
+    if (is_end())
+      error("unterminated literal");
+
+    if (peek() == quote) {
+      tok->str_value = std::string_view(data + content, _pos - content);
+      tok->text = std::string_view(data + begin, ++_pos - begin);
+      return;
+    }
+
+    _buf.assign(data + content, _pos - content);
+
+    auto hex = [](char c) -> int {
+      if (c >= '0' && c <= '9') return c - '0';
+      if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+      if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+      return -1;
+    };
+
+    while (!is_end() && peek() != quote) {
+      char x = peek();
+
+      if (x != '\\') {
+        _buf += x;
+        _pos++;
+        continue;
+      }
+
+      if (++_pos == _len)
+        break;
+
+      switch (x = peek()) {
+        case '0': _buf += '\0'; break;
+        case 't': _buf += '\t'; break;
+        case 'r': _buf += '\r'; break;
+        case 'n': _buf += '\n'; break;
+        case 'b': _buf += '\b'; break;
+        case '\\':
+        case '"':
+        case '\'':
+          _buf += x;
+          break;
+
+        // \xHH: U+0000 .. U+00FF
+        case 'x': {
+          int h, l;
+
+          if (_pos + 2 >= _len || (h = hex(get_char(_pos + 1))) < 0 || (l = hex(get_char(_pos + 2))) < 0)
+            error("expected two hex digits after '\\x'");
+
+          append_utf8(_buf, h * 16 + l);
+          _pos += 2;
+          break;
+        }
+
+        // \u{H..H}: 1 to 6 hex digits
+        case 'u': {
+          if (_pos + 1 >= _len || get_char(_pos + 1) != '{')
+            error("expected '{' after '\\u'");
+
+          _pos += 2;
+
+          uint32_t cp = 0;
+          size_t digits = 0;
+
+          for (int h; _pos < _len && (h = hex(peek())) >= 0; _pos++, digits++)
+            cp = cp * 16 + h;
+
+          if (is_end() || peek() != '}' || digits == 0 || digits > 6)
+            error("invalid unicode escape");
+
+          if (cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF))
+            error("invalid unicode code point");
+
+          append_utf8(_buf, cp);
+          break;
+        }
+
+        default:
+          error(std::string("unknown escape sequence '\\") + x + "'");
+      }
+
+      _pos++;
+    }
+
+    if (is_end())
+      error("unterminated literal");
+
+    tok->str_value = _source->strings.store(_buf);
+    tok->text = std::string_view(data + begin, ++_pos - begin);
+  }
+
   Token* Lexer::tokenize(char c, Token* prev) {
     TokenKind kind = TokenKind::Unknown;
     char const* str = getptr();
@@ -52,19 +304,10 @@ namespace fire {
 
     // 0-9
     if (std::isdigit(c)) {
-      kind = TokenKind::Int;
-      while (!is_end() && std::isdigit(peek()))
-        _pos++, len++;
-      if (peek() == '.') {
-        // "." [0-9]* "f"?
-        kind = TokenKind::Float;
-        _pos++, len++;
-        while (!is_end() && std::isdigit(peek()))
-          _pos++, len++;
-        if (peek() == 'f') _pos++, len++;
-      }
+      auto tok = new Token(TokenKind::Int, {}, prev, _source, pos);
+      lex_number(tok);
       pass_space();
-      return new Token(kind, std::string_view(str, len), prev, _source, pos);
+      return tok;
     }
 
     // a-z|A-Z|_
@@ -78,34 +321,10 @@ namespace fire {
 
     // char or string
     else if (c == '\'' || c == '"') {
-      kind = c == '"' ? TokenKind::String : TokenKind::Char;
-      _pos++;
-      char x;
-      std::string* ss_ = new std::string(1, c);
-      std::string&ss=*ss_;
-      while (!is_end() && (x = peek()) != c) {
-        if (x == '\\') {
-          _pos++;
-          switch (peek()) {
-            case '0': x = 0; break;
-            case 't': x = '\t'; break;
-            case 'r': x = '\r'; break;
-            case 'n': x = '\n'; break;
-            case 'b': x = '\b'; break;
-            default: todoimpl;
-          }
-        }
-        ss += x;
-        _pos++, len++;
-      }
-      if (peek() != c) {
-        alert;
-        throw 4545; // char or string literal not terminated
-      }
-      _pos++;
+      auto tok = new Token(c == '"' ? TokenKind::String : TokenKind::Char, {}, prev, _source, pos);
+      lex_string(tok, c);
       pass_space();
-      ss_->push_back(c);
-      return new Token(kind, std::string_view(ss_->data(),ss_->length()), prev, _source, pos);
+      return tok;
     }
 
     else if (_token_punct_str_map_ const* p = find_punct(getptr()); p != nullptr) {
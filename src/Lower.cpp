@@ -1,10 +1,291 @@
 #include "Lower.hpp"
+#include "Sema.hpp"
+#include "VM.hpp"
+#include "Trace.hpp"
 
 namespace fire {
 
+  using namespace IR::High;
+
   IR::High::Base* HighIRCreator::create_full_hir(Node* node) {
-    (void)node; 
-    todo;
+    Tracer::Span _span("ir", "create HIR");
+
+    HighIRCreator creator;
+
+    switch (node->kind) {
+      case NodeKind::Module: {
+        auto mod = new IRModule();
+
+        if (auto pool = node->as<NdModule>()->constants)
+          mod->constants = pool->get_constants();
+
+        creator.create_items(mod, node->as<NdModule>()->items, "");
+
+        // specialized templates. (one per distinct arguments)
+        for (auto inst : Sema::get_instance().get_template_instances()) {
+          if (inst->node->is(NodeKind::Function)) {
+            mod->items.push_back(
+                creator.create_function(inst->node->as<NdFunction>(), inst->get_name()));
+          } else {
+            auto C = inst->node->as<NdClass>();
+            auto name = inst->get_name();
+
+            mod->items.push_back(creator.create_struct(C, name));
+
+            for (auto M : C->methods)
+              mod->items.push_back(creator.create_function(M, name + "::" + M->name.text));
+          }
+        }
+
+        return mod;
+      }
+
+      case NodeKind::Function:
+        return creator.create_function(node->as<NdFunction>(),
+                                       std::string(node->as<NdFunction>()->name.text));
+
+      default:
+        todo;
+    }
+  }
+
+  void HighIRCreator::create_items(IRModule* mod, std::vector<Node*>& items,
+                                   std::string const& prefix) {
+    for (auto item : items) {
+      switch (item->kind) {
+        case NodeKind::Let:
+          mod->items.push_back(create_stmt(item));
+          break;
+
+        case NodeKind::Function: {
+          auto fn = item->as<NdFunction>();
+          if (!fn->is_template())
+            mod->items.push_back(create_function(fn, prefix + fn->name.text));
+          break;
+        }
+
+        case NodeKind::Class: {
+          auto C = item->as<NdClass>();
+          auto name = prefix + C->name.text;
+
+          if (C->is_template())
+            break;
+
+          mod->items.push_back(create_struct(C, name));
+
+          for (auto M : C->methods)
+            mod->items.push_back(create_function(M, name + "::" + M->name.text));
+
+          break;
+        }
+
+        case NodeKind::Enum: {
+          auto E = item->as<NdEnum>();
+          std::vector<std::string> names;
+
+          for (auto en : E->enumerators)
+            names.emplace_back(en->name.text);
+
+          mod->items.push_back(new IREnum(prefix + E->name.text, std::move(names)));
+          break;
+        }
+
+        case NodeKind::Namespace: {
+          auto NS = item->as<NdNamespace>();
+          create_items(mod, NS->items, prefix + NS->name + "::");
+          break;
+        }
+
+        default:
+          todo;
+      }
+    }
+  }
+
+  IRFunction* HighIRCreator::create_function(NdFunction* node, std::string const& name) {
+    Tracer::Span _span("ir", name, node->token.source->path);
+
+    finally_stack.clear();
+    loop_finally_base = 0;
+
+    return new IRFunction(name, create_scope(node->body),
+                          node->result_type ? node->result_type->ty : TypeInfo());
+  }
+
+  IRStruct* HighIRCreator::create_struct(NdClass* node, std::string const& name) {
+    std::vector<IRStruct::Field> fields;
+
+    // ordered by offset, including fields of base classes.
+    for (auto& field : VM::ClassLayout::of(node)->fields) {
+      fields.push_back({
+          .name = std::string(field.name),
+          .type = field.node->symbol_ptr->var_info->type,
+      });
+    }
+
+    return new IRStruct(name, std::move(fields));
+  }
+
+  IRScope* HighIRCreator::create_scope(NdScope* node) {
+    std::vector<IRStmt*> items;
+
+    for (auto item : node->items)
+      items.push_back(create_stmt(item));
+
+    return new IRScope(std::move(items));
+  }
+
+  IRStmt* HighIRCreator::with_finally(IRStmt* exit, size_t base) {
+    if (finally_stack.size() == base)
+      return exit;
+
+    std::vector<IRStmt*> items;
+
+    for (size_t i = finally_stack.size(); i > base; i--)
+      items.push_back(create_finally(i - 1));
+
+    items.push_back(exit);
+
+    return new IRScope(std::move(items));
+  }
+
+  IRScope* HighIRCreator::create_finally(size_t index) {
+    auto saved = finally_stack;
+    auto loop_base = loop_finally_base;
+
+    auto F = finally_stack[index];
+
+    finally_stack.resize(index);
+    loop_finally_base = F.loop_base;
+
+    auto block = create_scope(F.block);
+
+    finally_stack = std::move(saved);
+    loop_finally_base = loop_base;
+
+    return block;
+  }
+
+  IRStmt* HighIRCreator::create_stmt(Node* node) {
+    switch (node->kind) {
+      case NodeKind::Scope:
+        return create_scope(node->as<NdScope>());
+
+      case NodeKind::Let: {
+        auto let = node->as<NdLet>();
+        return new IRVardef(std::string(let->name.text),
+                            let->init ? create_expr(let->init) : nullptr);
+      }
+
+      case NodeKind::If: {
+        auto x = node->as<NdIf>();
+
+        auto ir = new IRIf(x->cond ? create_expr(x->cond) : nullptr, create_scope(x->thencode),
+                           x->elsecode ? create_stmt(x->elsecode) : nullptr);
+
+        if (x->vardef)
+          return new IRScope({create_stmt(x->vardef), ir});
+
+        return ir;
+      }
+
+      // while cond { body }
+      //   --> loop { if cond { } else { break; } body }
+      case NodeKind::While: {
+        auto x = node->as<NdWhile>();
+
+        auto base = loop_finally_base;
+        loop_finally_base = finally_stack.size();
+
+        std::vector<IRStmt*> items;
+
+        if (x->cond)
+          items.push_back(new IRIf(create_expr(x->cond), new IRScope({}), new IRBreak()));
+
+        items.push_back(create_scope(x->body));
+
+        loop_finally_base = base;
+
+        IRStmt* loop = new IRLoop(new IRScope(std::move(items)));
+
+        if (x->vardef)
+          return new IRScope({create_stmt(x->vardef), loop});
+
+        return loop;
+      }
+
+      case NodeKind::For: {
+        auto x = node->as<NdFor>();
+
+        auto base = loop_finally_base;
+        loop_finally_base = finally_stack.size();
+
+        auto body = create_scope(x->body);
+
+        loop_finally_base = base;
+
+        return new IRForeach(std::string(x->iter.text), create_expr(x->iterable), body);
+      }
+
+      case NodeKind::Break:
+        return with_finally(new IRBreak(), loop_finally_base);
+
+      case NodeKind::Continue:
+        return with_finally(new IRContinue(), loop_finally_base);
+
+      case NodeKind::Return: {
+        auto x = node->as<NdReturn>();
+
+        if (finally_stack.empty() || !x->expr)
+          return with_finally(new IRReturn(x->expr ? create_expr(x->expr) : nullptr), 0);
+
+        // the value must be evaluated before running finally blocks.
+        //   return expr;
+        //   --> { var tmp = expr; <finally...> return tmp; }
+        auto name = "__ret#" + std::to_string(tmp_var_count++);
+
+        return new IRScope({
+            new IRVardef(name, create_expr(x->expr)),
+            with_finally(new IRReturn(new IRExpr(name, x->expr->ty)), 0),
+        });
+      }
+
+      case NodeKind::Try: {
+        auto x = node->as<NdTry>();
+        auto scope = x->scope_ptr->as<SCTry>();
+
+        // normal and exceptional exits. (see VM::ExceptionTable)
+        IRScope* finally_block = x->finally_block ? create_scope(x->finally_block) : nullptr;
+
+        if (x->finally_block)
+          finally_stack.push_back({.block = x->finally_block, .loop_base = loop_finally_base});
+
+        auto body = create_scope(x->body);
+
+        std::vector<IRTryCatch::Catch> catches;
+
+        for (size_t i = 0; i < x->catches.size(); i++) {
+          catches.push_back({
+              .holder_name = std::string(x->catches[i]->holder.text),
+              .holder_type = scope->catches[i]->holder_name->var_info->type,
+              .body = create_scope(x->catches[i]->body),
+          });
+        }
+
+        if (x->finally_block)
+          finally_stack.pop_back();
+
+        return new IRTryCatch(body, std::move(catches), finally_block);
+      }
+
+      default:
+        assert(node->is_expr_full());
+        return new IRExprStmt(create_expr(node));
+    }
+  }
+
+  IRExpr* HighIRCreator::create_expr(Node* node) {
+    return new IRExpr(node, node->ty);
   }
 
   IR::Middle::MIR* MiddleIRCreator::create_full_mir(Node* node) {
@@ -18,8 +299,12 @@ namespace fire {
   }
 
   IR::Low::LIR* NodeLower::lower_full(Node* node) {
-    (void)node;
+    Tracer::Span _span("ir", "lower");
+
+    auto hir = HighIRCreator::create_full_hir(node);
+
+    (void)hir;
     todo;
   }
 
-} // namespace fire
\ No newline at end of file
+} // namespace fire
@@ -1,10 +1,89 @@
 #include "Utils.hpp"
 #include "Object.hpp"
 #include "strconv.hpp"
+#include "Node.hpp"
+#include "VM.hpp"
 
 namespace fire {
   ObjNone* Object::none = new ObjNone();
 
+  ObjBool* ObjBool::get(bool v) {
+    static ObjBool* objs[2] = {new ObjBool(false), new ObjBool(true)};
+    return objs[v];
+  }
+
+  ObjInt* ObjInt::get(std::int64_t v) {
+    static ObjInt** objs = [] {
+      auto objs = new ObjInt*[SmallMax - SmallMin + 1];
+
+      for (std::int64_t i = SmallMin; i <= SmallMax; i++)
+        objs[i - SmallMin] = new ObjInt(i);
+
+      return objs;
+    }();
+
+    if (v < SmallMin || v > SmallMax)
+      return new ObjInt(v);
+
+    return objs[v - SmallMin];
+  }
+
+  ObjInstance::ObjInstance(VM::ClassLayout const* layout, size_t field_count)
+      : Object(TypeKind::Class), layout(layout), field_count(field_count) {
+    type.class_node = layout->node;
+
+    for (size_t i = 0; i < field_count; i++)
+      fields()[i] = Object::none;
+  }
+
+  ObjInstance* ObjInstance::create(VM::ClassLayout const* layout) {
+    size_t count = layout->field_count();
+
+    void* p = ::operator new(sizeof(ObjInstance) + sizeof(Object*) * count);
+
+    return new (p) ObjInstance(layout, count);
+  }
+
+  Object* ObjInstance::clone() const {
+    auto x = ObjInstance::create(layout);
+
+    for (size_t i = 0; i < field_count; i++)
+      x->fields()[i] = fields()[i];
+
+    return x;
+  }
+
+  ObjString& ObjString::append(ObjChar* ch) {
+    data.push_back(ch->val);
+    return *this;
+  }
+
+  ObjString& ObjString::append(ObjString* str) {
+    data.insert(data.end(), str->data.begin(), str->data.end());
+    return *this;
+  }
+
+  ObjString* ObjString::concat(ObjString const* a, Object const* b) {
+    auto str = new ObjString();
+
+    char16_t const* p;
+    size_t len;
+
+    if (b->type.kind == TypeKind::Char) {
+      p = &b->as<ObjChar>()->val;
+      len = 1;
+    } else {
+      p = b->as<ObjString>()->data.data();
+      len = b->as<ObjString>()->data.size();
+    }
+
+    str->data.reserve(a->data.size() + len);
+    str->data.insert(str->data.end(), a->data.begin(), a->data.end());
+    str->data.insert(str->data.end(), p, p + len);
+
+    return str;
+  }
+
   std::string Object::to_string() const {
     switch (type.kind) {
     case TypeKind::None:
@@ -19,10 +98,8 @@ namespace fire {
     case TypeKind::Bool:
       return as<ObjBool>()->val ? "true" : "false";
 
-    case TypeKind::Char: {
-      char16_t buf[2]{as<ObjChar>()->val,0};
-      return utf16_to_utf8_cpp(buf);
-    }
+    case TypeKind::Char:
+      return utf16_to_utf8_len_cpp(&as<ObjChar>()->val, 1);
 
     case TypeKind::String:
       return utf16_to_utf8_len_cpp(as<ObjString>()->data.data(), as<ObjString>()->data.size());
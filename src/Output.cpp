@@ -0,0 +1,163 @@
+#include <cerrno>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+
+#include <unistd.h>
+
+#include "Utils.hpp"
+#include "Object.hpp"
+#include "strconv.hpp"
+#include "Output.hpp"
+
+namespace fire {
+
+  // longest text of a float. ("%f" of DBL_MAX is 316 chars)
+  static constexpr size_t FloatMaxChars = 320;
+
+  Output::Output(int fd, bool line_buffered)
+      : fd(fd), line_buffered(line_buffered), buf(new char[BufferSize]) {
+  }
+
+  Output::~Output() {
+    flush();
+  }
+
+  Output& Output::get_stdout() {
+    static Output* inst = [] {
+      std::atexit(Output::finish);
+      return new Output(STDOUT_FILENO, isatty(STDOUT_FILENO));
+    }();
+
+    return *inst;
+  }
+
+  void Output::before_read() {
+    get_stdout().flush();
+  }
+
+  void Output::finish() {
+    get_stdout().flush();
+  }
+
+  bool Output::flush() {
+    // can't write anymore. (closed pipe etc.)
+    if (failed) {
+      used = 0;
+      return false;
+    }
+
+    char const* p = buf.get();
+    size_t left = used;
+
+    while (left > 0) {
+      ssize_t n = ::write(fd, p, left);
+
+      if (n < 0) {
+        if (errno == EINTR)
+          continue;
+
+        failed = true;
+        break;
+      }
+
+      p += n;
+      left -= n;
+    }
+
+    // rest is dropped.
+    total += used - left;
+    used = 0;
+
+    return left == 0;
+  }
+
+  void Output::write(std::string_view str) {
+    while (!str.empty()) {
+      size_t n = std::min(str.length(), BufferSize - used);
+
+      std::memcpy(buf.get() + used, str.data(), n);
+      used += n;
+      str.remove_prefix(n);
+
+      if (used == BufferSize)
+        flush();
+    }
+  }
+
+  void Output::write(char c) {
+    *reserve(1) = c;
+    used++;
+  }
+
+  void Output::write_utf16(char16_t const* str, size_t len) {
+    // by chunks which fit in the buffer.
+    size_t const chunk = BufferSize / 3;
+
+    while (len > 0) {
+      size_t n = std::min(len, chunk);
+
+      // don't split a surrogate pair.
+      if (n < len && str[n - 1] >= 0xD800 && str[n - 1] <= 0xDBFF)
+        n--;
+
+      used += utf16_to_utf8_into(reserve(utf16_to_utf8_max_length(n)), str, n);
+
+      str += n;
+      len -= n;
+    }
+  }
+
+  void Output::write_int(std::int64_t val) {
+    char* p = reserve(20);
+
+    used += std::to_chars(p, p + 20, val).ptr - p;
+  }
+
+  void Output::write_float(double val) {
+    char* p = reserve(FloatMaxChars);
+
+    used += std::to_chars(p, p + FloatMaxChars, val, std::chars_format::fixed, 6).ptr - p;
+  }
+
+  void Output::write_object(Object const* obj) {
+    switch (obj->type.kind) {
+      case TypeKind::None:
+        write("none");
+        break;
+
+      case TypeKind::Int:
+        write_int(obj->as<ObjInt>()->val);
+        break;
+
+      case TypeKind::Float:
+        write_float(obj->as<ObjFloat>()->val);
+        break;
+
+      case TypeKind::Bool:
+        write(obj->as<ObjBool>()->val ? "true" : "false");
+        break;
+
+      case TypeKind::Char:
+        write_utf16(&obj->as<ObjChar>()->val, 1);
+        break;
+
+      case TypeKind::String: {
+        auto& data = obj->as<ObjString>()->data;
+        write_utf16(data.data(), data.size());
+        break;
+      }
+
+      default:
+        write(obj->to_string());
+    }
+  }
+
+  void Output::newline() {
+    write('\n');
+
+    if (line_buffered)
+      flush();
+  }
+
+} // namespace fire
@@ -1,4 +1,5 @@
 #include <filesystem>
+#include <unordered_map>
 
 #include "Utils.hpp"
 #include "Driver.hpp"
@@ -7,6 +8,7 @@
 #include "FileSystem.hpp"
 
 #include "strconv.hpp"
+#include "Trace.hpp"
 
 namespace fire {
 
@@ -123,17 +125,11 @@ namespace fire {
     if (eat("self"))
       return new NdSelf(tok);
 
-    if (eat("true")) {
-      auto v = new NdValue(tok);
-      v->obj = new ObjBool(true);
-      return v;
-    }
+    if (eat("true"))
+      return new NdValue(tok, pool, pool->add_bool(true));
 
-    if (eat("false")) {
-      auto v = new NdValue(tok);
-      v->obj = new ObjBool(false);
-      return v;
-    }
+    if (eat("false"))
+      return new NdValue(tok, pool, pool->add_bool(false));
 
     if (eat("decltype")) {
       throw err::parses::cannot_use_decltype_here(tok);
@@ -143,41 +139,43 @@ namespace fire {
       return ps_symbol();
     }
 
-    NdValue* v = new NdValue(*cur);
+    size_t index;
 
     switch (cur->kind) {
       case TokenKind::Int:
-        v->obj = new ObjInt(std::atoll(cur->text.data()));
-        next();
+        index = pool->add_int(cur->int_value);
         break;
 
       case TokenKind::Float:
-        v->obj = new ObjFloat(std::atof(cur->text.data()));
-        next();
+        index = pool->add_float(cur->float_value);
         break;
 
       case TokenKind::Char: {
-        std::u16string s16 = utf8_to_utf16_len_cpp(cur->text.data() + 1, cur->text.length() - 2);
+        auto str = cur->str_value;
 
-        if (s16.empty() || s16.size() > 1) {
+        if (utf8_to_utf16_length(str.data(), str.length()) != 1) {
           throw err::invalid_character_literal(*cur);
         }
-        v->obj = new ObjChar(s16[0]);
-        next();
+
+        char16_t c;
+        utf8_to_utf16_into(&c, str.data(), str.length());
+
+        index = pool->add_char(c);
         break;
       }
 
-      case TokenKind::String: {
-        v->obj = ObjString::from_char16_ptr_move(utf8_to_utf16_with_len(nullptr,cur->text.data()+1, cur->text.length()-2));
-        next();
+      case TokenKind::String:
+        strbuf.clear();
+        utf8_to_utf16_append(strbuf, cur->str_value.data(), cur->str_value.length());
+
+        index = pool->add_string(strbuf);
         break;
-      }
 
       default:
         throw err::invalid_syntax(*cur);
     }
 
-    return v;
+    return new NdValue(*next(), pool, index);
   }
 
   Node* Parser::ps_subscript() {
@@ -232,7 +230,7 @@ namespace fire {
           if (cur->kind != TokenKind::Int) {
             throw err::expected_but_found(*cur, "int");
           }
-          x = new NdGetTupleElement(tok, x, std::atoi(cur->text.data()));
+          x = new NdGetTupleElement(tok, x, cur->int_value);
           x->as<NdGetTupleElement>()->index_tok = cur;
           next();
           expect(">");
@@ -309,8 +307,7 @@ namespace fire {
     }
 
     if (eat("-")) {
-      auto zero = new NdValue(tok);
-      zero->obj = new ObjInt(0);
+      auto zero = new NdValue(tok, pool, pool->add_int(0));
       return new NdExpr(NodeKind::Sub, tok, zero, ps_subscript());
     }
 
@@ -689,6 +686,7 @@ namespace fire {
         if (node->m_new)
           throw err::duplicate_of_definition(*cur->prev, node->m_new->token);
         auto newfn = new NdFunction(*cur->prev, *cur->prev);
+        newfn->take_self = true;
         if (eat("(") && !eat(")")) {
           do {
             auto& A = newfn->args.emplace_back(*expect_ident(), nullptr);
@@ -802,18 +800,24 @@ namespace fire {
   }
 
   Node* Parser::ps_mod_item() {
-    if (look("var"))
-      return ps_let();
-    if (look("fn"))
-      return ps_function();
-    if (look("class"))
-      return ps_class();
-    if (look("enum"))
-      return ps_enum();
-    if (look("namespace"))
-      return ps_namespace();
+    Node* item = nullptr;
 
-    throw err::expected_item_of_module(*cur);
+    if (look("var"))
+      item = ps_let();
+    else if (look("fn"))
+      item = ps_function();
+    else if (look("class"))
+      item = ps_class();
+    else if (look("enum"))
+      item = ps_enum();
+    else if (look("namespace"))
+      item = ps_namespace();
+    else
+      throw err::expected_item_of_module(*cur);
+
+    item->end_token = cur->prev;
+
+    return item;
   }
 
   void Parser::ps_do_import(Token* import_token, std::string path) {
@@ -852,6 +856,8 @@ namespace fire {
 
     expect(";");
 
+    Tracer::Span _span("frontend", "import " + path, source.path);
+
     try {
       ps_do_import(import_token, std::filesystem::absolute(source.get_folder() + path).string());
     }
@@ -859,7 +865,8 @@ namespace fire {
       auto fol = FileSystem::GetFolderOfFile(source.path);
 
       while (true) {
-        if (fol == Driver::get_instance()->get_first_cwd()) {
+        // up to the first cwd, or the root if the file is not in it.
+        if (fol.empty() || fol == Driver::get_instance()->get_first_cwd()) {
           e.msg.pop_back();
           e.msg += ".fire'";
           throw e;
@@ -880,32 +887,33 @@ namespace fire {
     }
   }
 
-  NdModule* Parser::ps_mod() {
+  NdModule* Parser::ps_mod(bool with_imports) {
     NdModule* mod = new NdModule(*cur);
 
+    mod->constants = pool;
+
+    // marked before parsing imports, to stop cycles.
+    source.is_node_imported = true;
+
     while (!is_end() && eat("import")) {
       ps_import();
     }
 
     for (auto&& src : source.imports) {
-      if (src->is_node_imported)
+      if (!with_imports || src->is_node_imported)
         continue;
 
-      auto submod = src->parse();
+      src->is_node_imported = true;
+
+      auto submod = src->parse(pool);
 
       for (auto&& item : submod->items) {
         mod->items.emplace_back(item);
       }
-
-      src->is_node_imported = true;
     }
 
-    while (!is_end()) {
-      if (look("import")) {
-        throw err::parses::import_not_allowed_here(*cur);
-      }
-
-      auto item = mod->items.emplace_back(ps_mod_item());
+    for (auto item : ps_items()) {
+      mod->items.emplace_back(item);
 
       if (item->is(NodeKind::Function)) {
         if (auto f = item->as<NdFunction>(); f->name.text == "main") {
@@ -921,33 +929,45 @@ namespace fire {
     return mod;
   }
 
+  std::vector<Node*> Parser::ps_items() {
+    std::vector<Node*> items;
+
+    while (!is_end()) {
+      if (look("import")) {
+        throw err::parses::import_not_allowed_here(*cur);
+      }
+
+      items.emplace_back(ps_mod_item());
+    }
+
+    return items;
+  }
+
+  //
+  // merge namespaces of same name into the first one.
+  // items of later blocks are appended in order of appearance.
   void Parser::merge_namespaces(std::vector<Node*>& items) {
-    bool flag = false;
-
-  __begin__:;
-    flag = false;
-    for (size_t i = 0; i < items.size();) {
-      if (auto orig = items[i]->as<NdNamespace>(); orig->is(NodeKind::Namespace)) {
-        for (size_t j = i + 1; j < items.size(); j++) {
-          if (auto dup = items[j]->as<NdNamespace>();
-              dup->is(NodeKind::Namespace) && dup->name == orig->name) {
-            for (auto x : dup->items)
-              orig->items.push_back(x);
-            delete dup;
-            items.erase(items.begin() + j);
-            flag = true;
-            goto __merged;
-          }
+    std::unordered_map<std::string_view, NdNamespace*> first;
+    size_t count = 0;
+
+    for (auto x : items) {
+      if (x->is(NodeKind::Namespace)) {
+        auto ns = x->as<NdNamespace>();
+
+        if (auto [it, inserted] = first.try_emplace(ns->name, ns); !inserted) {
+          auto& dest = it->second->items;
+
+          dest.insert(dest.end(), ns->items.begin(), ns->items.end());
+
+          delete ns;
+          continue;
         }
-        i++;
-      __merged:;
-      } else {
-        i++;
       }
+
+      items[count++] = x;
     }
 
-    if (flag)
-      goto __begin__;
+    items.resize(count);
 
     for (auto&& x : items) {
       if (x->is(NodeKind::Namespace))
@@ -955,37 +975,59 @@ namespace fire {
     }
   }
 
+  static int item_order(Node* item) {
+    switch (item->kind) {
+      case NodeKind::Let:
+        return 0;
+      case NodeKind::Namespace:
+        return 1;
+      case NodeKind::Enum:
+        return 2;
+      case NodeKind::Class:
+        return 3;
+      case NodeKind::Function:
+        return 4;
+      default:
+        return -1; // dropped
+    }
+  }
+
+  //
+  // sort items by kind: Let, Namespace, Enum, Class, Function.
+  // order in same kind is kept. (counting sort)
   void Parser::reorder_items(std::vector<Node*>& items) {
-    // move all enums at first
+    size_t offsets[6] = {};
+    bool sorted = true;
+    int last = 0;
 
-    std::vector<Node*> _new;
+    for (auto&& x : items) {
+      auto order = item_order(x);
 
-    for (auto&& x : items)
-      if (x->is(NodeKind::Let)) {
-        _new.push_back(x);
-      }
+      if (order < last) {
+        sorted = false;
 
-    for (auto&& x : items)
-      if (x->is(NodeKind::Namespace)) {
-        _new.push_back(x);
+        if (order < 0)
+          continue;
       }
 
-    for (auto&& x : items)
-      if (x->is(NodeKind::Enum)) {
-        _new.push_back(x);
-      }
+      last = order;
+      offsets[order + 1]++;
+    }
 
-    for (auto&& x : items)
-      if (x->is(NodeKind::Class)) {
-        _new.push_back(x);
-      }
+    // keep if already sorted.
+    if (!sorted) {
+      for (int i = 1; i < 6; i++)
+        offsets[i] += offsets[i - 1];
+
+      std::vector<Node*> _new(offsets[5]);
 
-    for (auto&& x : items)
-      if (x->is(NodeKind::Function)) {
-        _new.push_back(x);
+      for (auto&& x : items) {
+        if (auto order = item_order(x); order >= 0)
+          _new[offsets[order]++] = x;
       }
 
-    items = std::move(_new);
+      items = std::move(_new);
+    }
 
     for (auto&& x : items) {
       if (x->is(NodeKind::Namespace))
@@ -0,0 +1,204 @@
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "Utils.hpp"
+#include "Node.hpp"
+#include "SourceFile.hpp"
+#include "Profiler.hpp"
+
+// glibc before 2.37 doesn't define the name. (same as <asm-generic/siginfo.h>)
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+namespace fire::VM {
+
+  // profiler sampling now. (for the signal handler)
+  static Profiler* volatile active = nullptr;
+
+  static constexpr size_t SampleCapacity = 1 << 16;
+  static constexpr size_t RecordCapacity = 1 << 20;
+
+  Profiler& Profiler::get_instance() {
+    static Profiler inst;
+    return inst;
+  }
+
+  void Profiler::enable(std::string const& path) {
+    if (!enabled)
+      std::atexit(Profiler::finish);
+
+    this->enabled = true;
+    this->path = path;
+  }
+
+  bool Profiler::start(Context* ctx) {
+    if (running)
+      return false;
+
+    // allocate here, not in the handler.
+    if (!records) {
+      records.reset(new Record[RecordCapacity]);
+      samples.reset(new Sample[SampleCapacity]);
+      record_cap = RecordCapacity;
+      sample_cap = SampleCapacity;
+    }
+
+    struct sigaction sa = {};
+    sa.sa_sigaction = Profiler::on_sigprof;
+    sa.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+
+    if (sigaction(SIGPROF, &sa, &old_action) != 0)
+      return false;
+
+    // count only cpu time of this thread, and send the signal to this thread.
+    sigevent sev = {};
+    sev.sigev_notify = SIGEV_THREAD_ID;
+    sev.sigev_signo = SIGPROF;
+    sev.sigev_notify_thread_id = (pid_t)syscall(SYS_gettid);
+
+    if (timer_create(CLOCK_THREAD_CPUTIME_ID, &sev, &timer) != 0) {
+      sigaction(SIGPROF, &old_action, nullptr);
+      return false;
+    }
+
+    long interval_ns = 1000000000L / hz;
+
+    itimerspec its = {};
+    its.it_interval.tv_sec = interval_ns / 1000000000L;
+    its.it_interval.tv_nsec = interval_ns % 1000000000L;
+    its.it_value = its.it_interval;
+
+    this->ctx = ctx;
+    active = this;
+
+    if (timer_settime(timer, 0, &its, nullptr) != 0) {
+      timer_delete(timer);
+      sigaction(SIGPROF, &old_action, nullptr);
+
+      active = nullptr;
+      this->ctx = nullptr;
+
+      return false;
+    }
+
+    return running = true;
+  }
+
+  void Profiler::stop() {
+    if (!running)
+      return;
+
+    timer_delete(timer);
+    sigaction(SIGPROF, &old_action, nullptr);
+
+    active = nullptr;
+    ctx = nullptr;
+    running = false;
+  }
+
+  //
+  // async-signal-safe: no allocation, no lock.
+  void Profiler::on_sigprof(int, siginfo_t*, void*) {
+    auto P = active;
+
+    if (!P || !P->ctx)
+      return;
+
+    if (P->sample_count == P->sample_cap) {
+      P->dropped++;
+      return;
+    }
+
+    size_t begin = P->record_count;
+    size_t depth = 0;
+
+    for (Frame const* f = P->ctx->frame; f && depth < MaxDepth; f = f->prev) {
+      if (begin + depth == P->record_cap) {
+        P->dropped++;
+        return;
+      }
+
+      P->records[begin + depth] = {.func = f->func, .pc = f->pc};
+      depth++;
+    }
+
+    if (depth == 0)
+      return;
+
+    P->samples[P->sample_count] = {.begin = begin, .depth = depth};
+
+    P->record_count = begin + depth;
+    P->sample_count = P->sample_count + 1;
+  }
+
+  static std::string frame_to_s(Function const* func, size_t pc) {
+    if (!func || !func->node)
+      return "[unknown]";
+
+    std::string name{func->node->name.text};
+
+    if (auto tok = func->token_of(pc); tok && tok->source) {
+      auto const& path = tok->source->path;
+      name += format(" (%s:%zu)", path.substr(path.find_last_of('/') + 1).c_str(), tok->line);
+    }
+
+    return name;
+  }
+
+  void Profiler::write_collapsed(std::string const& path) const {
+    auto fp = std::fopen(path.c_str(), "w");
+
+    if (!fp) {
+      std::fprintf(stderr, "cannot open file: %s\n", path.c_str());
+      return;
+    }
+
+    std::map<std::pair<Function const*, size_t>, std::string> names;
+    std::map<std::string, size_t> stacks;
+
+    for (size_t i = 0; i < sample_count; i++) {
+      auto const& S = samples[i];
+      std::string stack;
+
+      // outermost first
+      for (size_t d = S.depth; d-- > 0;) {
+        auto const& R = records[S.begin + d];
+        auto key = std::make_pair(R.func, R.pc);
+
+        auto it = names.find(key);
+
+        if (it == names.end())
+          it = names.emplace(key, frame_to_s(R.func, R.pc)).first;
+
+        if (!stack.empty())
+          stack += ';';
+
+        stack += it->second;
+      }
+
+      stacks[stack]++;
+    }
+
+    for (auto const& [stack, count] : stacks)
+      std::fprintf(fp, "%s %zu\n", stack.c_str(), count);
+
+    std::fclose(fp);
+  }
+
+  void Profiler::finish() {
+    auto& P = get_instance();
+
+    P.stop();
+    P.write_collapsed(P.path);
+
+    if (P.dropped)
+      std::fprintf(stderr, "profiler: %zu samples dropped\n", (size_t)P.dropped);
+  }
+
+} // namespace fire::VM
@@ -0,0 +1,368 @@
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+
+#include <sys/stat.h>
+
+#include "Utils.hpp"
+#include "FileSystem.hpp"
+#include "Error.hpp"
+#include "Parser.hpp"
+#include "Sema.hpp"
+#include "Lower.hpp"
+#include "Program.hpp"
+
+namespace fire {
+
+  static bool same_stamp(timespec const& a, off_t size_a, struct stat const& st) {
+    return a.tv_sec == st.st_mtim.tv_sec && a.tv_nsec == st.st_mtim.tv_nsec &&
+           size_a == st.st_size;
+  }
+
+  Program::Program(std::string const& path)
+      : path(std::filesystem::absolute(path).string()), pool(new ConstantPool()),
+        sema(Sema::create()) {
+  }
+
+  int Program::build() {
+    SourceFile::set_registry(&registry);
+
+    if (!main_file && !(main_file = SourceFile::read(path))) {
+      std::printf("cannot open file: %s\n", path.c_str());
+      SourceFile::set_registry(nullptr);
+      return 1;
+    }
+
+    // imports are relative to the folder. (same as Driver)
+    std::error_code ec;
+    std::filesystem::current_path(main_file->get_folder(), ec);
+
+    int code = run_pipeline();
+
+    update_stamps();
+
+    SourceFile::set_registry(nullptr);
+
+    return code;
+  }
+
+  int Program::run_pipeline() {
+    parsed_count = 0;
+    checked_count = 0;
+
+    try {
+      std::vector<Node*> items;
+
+      //
+      // items analyzed already can't be checked again.
+      // files which have them are parsed again, from their tokens.
+      // (nodes of the second pass are new, so they are not stale)
+      for (int pass = 0; pass < 2; pass++) {
+        items = collect();
+
+        Parser::reorder_items(items);
+
+        std::unordered_set<SourceFile const*> stale;
+
+        for (auto node : sema->get_stale_items(items))
+          stale.insert(node->token.source);
+
+        if (stale.empty())
+          break;
+
+        for (auto& [_, src] : registry) {
+          if (stale.count(src))
+            src->parsed_mod = nullptr;
+        }
+      }
+
+      Token tok(TokenKind::Eof);
+      tok.source = main_file;
+
+      auto mod = new NdModule(tok);
+
+      mod->name = "__main__";
+      mod->constants = pool;
+      mod->items = items;
+
+      for (auto item : items) {
+        if (item->token.source != main_file || !item->is(NodeKind::Function))
+          continue;
+
+        if (auto f = item->as<NdFunction>(); f->name.text == "main") {
+          if (mod->main_fn)
+            throw err::duplicate_of_definition(f->name, mod->main_fn->name);
+
+          mod->main_fn = f;
+        }
+      }
+
+      if (!mod->main_fn) {
+        printf("fatal error: function 'main' not defined.\n");
+        return -1;
+      } else if (!mod->main_fn->result_type) {
+        printf("fatal error: function 'main' must have a return type.\n");
+        return -1;
+      }
+
+      checked_count = sema->reanalyze(mod);
+
+      //
+      // clean items are taken over from previous analysis.
+      // keep them in files, instead of new nodes.
+      // (files sharing a namespace are parsed each time, nothing to keep)
+      for (size_t i = 0; i < items.size(); i++) {
+        if (items[i] == mod->items[i])
+          continue;
+
+        auto parsed = items[i]->token.source->parsed_mod;
+
+        if (!parsed)
+          continue;
+
+        auto& own = parsed->items;
+
+        std::replace(own.begin(), own.end(), items[i], mod->items[i]);
+      }
+
+      NodeLower::lower_full(mod);
+
+      return 0;
+    }
+    catch (err::e& e) {
+      e.print();
+    }
+    catch (todo_error& e) {
+      std::fprintf(stderr, "\t#todoimpl at %s:%d\n", e.file, e.line);
+      return 22;
+    }
+
+    return 1;
+  }
+
+  std::vector<Node*> Program::collect() {
+    std::vector<Node*> items;
+    std::unordered_set<SourceFile*> visited;
+
+    collect_items(main_file, visited, items);
+
+    //
+    // files which have a namespace of same name as another file.
+    std::unordered_map<std::string_view, SourceFile const*> first;
+    std::unordered_set<SourceFile const*> shared;
+
+    for (auto item : items) {
+      if (!item->is(NodeKind::Namespace))
+        continue;
+
+      auto [it, inserted] = first.try_emplace(item->as<NdNamespace>()->name, item->token.source);
+
+      if (!inserted && it->second != item->token.source) {
+        shared.insert(it->second);
+        shared.insert(item->token.source);
+      }
+    }
+
+    if (shared.empty())
+      return items;
+
+    //
+    // they are merged into a node by parser, so nodes of these files are
+    // changed. parse them again each time.
+    auto forget = [&] {
+      for (auto src : visited) {
+        if (shared.count(src))
+          src->parsed_mod = nullptr;
+      }
+    };
+
+    forget();
+
+    items.clear();
+    visited.clear();
+
+    collect_items(main_file, visited, items);
+
+    Parser::merge_namespaces(items);
+
+    forget();
+
+    return items;
+  }
+
+  void Program::collect_items(SourceFile* src, std::unordered_set<SourceFile*>& visited,
+                              std::vector<Node*>& items) {
+    if (!visited.insert(src).second)
+      return;
+
+    if (!src->parsed_mod)
+      parse_file(src);
+
+    for (auto imported : src->imports)
+      collect_items(imported, visited, items);
+
+    items.insert(items.end(), src->parsed_mod->items.begin(), src->parsed_mod->items.end());
+  }
+
+  void Program::parse_file(SourceFile* src) {
+    src->imports.clear();
+    src->import_dirs.clear();
+
+    auto mod = Parser(*src, src->lex(), pool).ps_mod(false);
+
+    Parser::merge_namespaces(mod->items);
+
+    src->parsed_mod = mod;
+    parsed_count++;
+  }
+
+  bool Program::update_path(std::string const& path) {
+    bool changed = false;
+
+    if (auto it = registry.find(path); it != registry.end()) {
+      SourceFile::set_registry(&registry);
+      changed = reload_file(it->second);
+      SourceFile::set_registry(nullptr);
+    }
+
+    // created or removed in an imported folder.
+    auto folder = FileSystem::GetFolderOfFile(path);
+
+    for (auto& [_, src] : registry) {
+      for (auto& dir : src->import_dirs) {
+        if (FileSystem::StripTrailingSlash(dir) == folder) {
+          src->parsed_mod = nullptr;
+          changed = true;
+        }
+      }
+    }
+
+    return changed;
+  }
+
+  bool Program::refresh() {
+    std::vector<SourceFile*> files;
+
+    for (auto& [_, src] : registry)
+      files.push_back(src);
+
+    bool changed = false;
+
+    SourceFile::set_registry(&registry);
+
+    for (auto src : files) {
+      struct stat st;
+
+      if (stat(src->path.c_str(), &st) != 0) {
+        stamps.erase(src->path);
+        missing.insert(src->path);
+        invalidate_importers(src);
+
+        // read again at next build.
+        if (src == main_file) {
+          retired.push_back(main_file);
+          main_file = nullptr;
+        }
+
+        changed = true;
+        continue;
+      }
+
+      auto& stamp = stamps[src->path];
+
+      if (same_stamp(stamp.mtime, stamp.size, st))
+        continue;
+
+      stamp = {st.st_mtim, st.st_size};
+
+      if (reload_file(src))
+        changed = true;
+    }
+
+    SourceFile::set_registry(nullptr);
+
+    // files are created or removed in imported folders.
+    for (auto src : files) {
+      for (auto& dir : src->import_dirs) {
+        struct stat st;
+
+        if (stat(dir.c_str(), &st) == 0) {
+          auto& stamp = stamps[dir];
+
+          if (same_stamp(stamp.mtime, stamp.size, st))
+            continue;
+
+          stamp = {st.st_mtim, st.st_size};
+        }
+
+        src->parsed_mod = nullptr;
+        changed = true;
+      }
+    }
+
+    return changed;
+  }
+
+  bool Program::reload_file(SourceFile* src) {
+    auto fresh = src->reload();
+
+    if (!fresh) {
+      missing.insert(src->path);
+      invalidate_importers(src);
+      return true;
+    }
+
+    bool restored = missing.erase(src->path) != 0;
+
+    // saved without changes.
+    if (fresh->data == src->data) {
+      registry[src->path] = src;
+      delete fresh;
+      return restored;
+    }
+
+    replace_file(src, fresh);
+
+    return true;
+  }
+
+  //
+  // src is a new version of old. (registered already)
+  void Program::replace_file(SourceFile* old, SourceFile* src) {
+    for (auto& [_, x] : registry) {
+      std::replace(x->imports.begin(), x->imports.end(), old, src);
+
+      if (x->parent == old)
+        x->parent = src;
+    }
+
+    if (main_file == old)
+      main_file = src;
+
+    retired.push_back(old);
+  }
+
+  void Program::invalidate_importers(SourceFile const* src) {
+    for (auto& [_, x] : registry) {
+      if (std::find(x->imports.begin(), x->imports.end(), src) != x->imports.end())
+        x->parsed_mod = nullptr;
+    }
+  }
+
+  void Program::update_stamps() {
+    auto add = [this](std::string const& path) {
+      struct stat st;
+
+      if (!stamps.count(path) && stat(path.c_str(), &st) == 0)
+        stamps[path] = {st.st_mtim, st.st_size};
+    };
+
+    for (auto& [path, src] : registry) {
+      add(path);
+
+      for (auto& dir : src->import_dirs)
+        add(dir);
+    }
+  }
+
+} // namespace fire
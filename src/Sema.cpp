@@ -6,11 +6,11 @@
 #include "Sema.hpp"
 
 #include "BuiltinFunc.hpp"
+#include "ThreadPool.hpp"
+#include "Trace.hpp"
 
 namespace fire {
 
-  static Sema* __inst = nullptr;
-
   // clang-format off
   static std::pair<std::string, TypeKind> bultin_class_names[] {
     {"none", TypeKind::None},
@@ -31,11 +31,23 @@ namespace fire {
   Sema::Sema() {
   }
 
+  // initialization of local static is thread-safe.
   Sema& Sema::get_instance() {
-    if (!__inst) {
-      __inst = new Sema();
-    }
-    return *__inst;
+    static Sema* inst = new Sema();
+    return *inst;
+  }
+
+  Sema* Sema::create() {
+    auto& G = get_instance();
+    auto S = new Sema();
+
+    if (G.jobs != 1 && !G.pool)
+      G.pool = new ThreadPool(G.jobs ? G.jobs : ThreadPool::default_size());
+
+    S->jobs = G.jobs;
+    S->pool = G.pool;
+
+    return S;
   }
 
   void Sema::analyze_all(NdModule* mod) {
@@ -43,17 +55,62 @@ namespace fire {
   }
 
   void Sema::analyze_full(NdModule* mod) {
+    template_instances.clear();
+    template_instance_list.clear();
+    item_infos.clear();
+
+    register_items(mod);
+
+    cur_module = mod;
     root_scope = new SCModule(mod, nullptr);
 
     NameResolver resolver(*this);
 
     alert;
-    resolver.on_module(mod, {});
+    {
+      Tracer::Span _span("sema", "resolve names");
+      resolver.on_module(mod, {});
+    }
 
     TypeChecker checker(*this);
 
     alert;
-    checker.check_module(mod, {});
+    {
+      Tracer::Span _span("sema", "check types");
+      checker.check_module(mod, {});
+    }
+  }
+
+  void Sema::run_parallel(size_t count, std::function<void(size_t)> fn) {
+    if (jobs == 1 || count <= 1) {
+      for (size_t i = 0; i < count; i++)
+        fn(i);
+      return;
+    }
+
+    if (!pool)
+      pool = new ThreadPool(jobs ? jobs : ThreadPool::default_size());
+
+    std::vector<std::exception_ptr> errors(count);
+
+    for (size_t i = 0; i < count; i++) {
+      pool->submit([&fn, &errors, i] {
+        try {
+          fn(i);
+        }
+        catch (...) {
+          errors[i] = std::current_exception();
+        }
+      });
+    }
+
+    pool->wait();
+
+    // same error as serial checking.
+    for (auto& e : errors) {
+      if (e)
+        std::rethrow_exception(e);
+    }
   }
 
   Symbol* Sema::new_variable_symbol(NdLet* let) {
@@ -93,11 +150,17 @@ namespace fire {
         }
       }
 
-      if (result.hits.size() >= 1)
+      if (result.hits.size() >= 1) {
+        if (scope->kind == ScopeKind::Module)
+          add_dependency(ctx.cur_item, node->name.text);
+
         break;
+      }
     }
 
     if (result.hits.empty()) {
+      // builtin or undefined yet.
+      add_dependency(ctx.cur_item, node->name.text);
 
       for (auto& [name, kind] : bultin_class_names) {
         if (name == node->name.text) {
@@ -111,20 +174,18 @@ namespace fire {
       }
 
       // find builtin funcs
-      for (auto& func : builtin_func_table) {
-        if (func->name == node->name.text) {
-          TypeInfo ty = TypeInfo(TypeKind::Function);
-          ty.parameters = func->arg_types;
-          ty.parameters.insert(ty.parameters.begin(), func->result_type);
-          ty.is_var_arg_functor = func->is_var_args;
-          result.hits.push_back( node->symbol_ptr = new Symbol{
-              .name = func->name,
-              .kind = SymbolKind::BuiltinFunc,
-              .type = ty,
-              .builtin_f = func,
-          });
-          return result;
-        }
+      if (auto func = BuiltinRegistry::get_instance().find_func(node->name.text); func) {
+        TypeInfo ty = TypeInfo(TypeKind::Function);
+        ty.parameters = func->arg_types;
+        ty.parameters.insert(ty.parameters.begin(), func->result_type);
+        ty.is_var_arg_functor = func->is_var_args;
+        result.hits.push_back( node->symbol_ptr = new Symbol{
+            .name = func->name,
+            .kind = SymbolKind::BuiltinFunc,
+            .type = ty,
+            .builtin_f = func,
+        });
+        return result;
       }
 
       return result;
@@ -0,0 +1,348 @@
+#include "Utils.hpp"
+#include "Sema.hpp"
+#include "Trace.hpp"
+
+namespace fire {
+
+  static std::string_view get_item_name(Node* item) {
+    switch (item->kind) {
+      case NodeKind::Let:
+        return item->as<NdLet>()->name.text;
+      case NodeKind::Function:
+        return item->as<NdFunction>()->name.text;
+      case NodeKind::Class:
+        return item->as<NdClass>()->name.text;
+      case NodeKind::Enum:
+        return item->as<NdEnum>()->name.text;
+      case NodeKind::Namespace:
+        return item->as<NdNamespace>()->name;
+    }
+    todo;
+  }
+
+  //
+  // hash of tokens of the item.
+  // not affected by position, spaces and comments.
+  static size_t get_fingerprint(Node* item) {
+    size_t h = std::hash<std::string_view>()(get_item_name(item));
+
+    // namespaces with same name are merged by parser.
+    if (item->is(NodeKind::Namespace)) {
+      for (auto x : item->as<NdNamespace>()->items)
+        h = h * 31 + get_fingerprint(x);
+      return h;
+    }
+
+    for (Token const* t = &item->token; t; t = t->next) {
+      h = h * 31 + std::hash<std::string_view>()(t->text);
+
+      if (t == item->end_token)
+        break;
+    }
+
+    return h;
+  }
+
+  // fingerprints of items in known are not computed again.
+  static std::vector<ItemInfo> make_item_infos(std::vector<Node*> const& items,
+                                               std::unordered_map<Node*, ItemInfo> const* known =
+                                                   nullptr) {
+    std::vector<ItemInfo> infos;
+    std::unordered_map<std::string, int> counts;
+
+    for (auto item : items) {
+      auto& info = infos.emplace_back();
+
+      info.name = get_item_name(item);
+      info.key = format("%d:%s", (int)item->kind, info.name.c_str());
+      info.key += "#" + std::to_string(counts[info.key]++);
+
+      if (known && known->count(item))
+        info.fingerprint = known->at(item).fingerprint;
+      else
+        info.fingerprint = get_fingerprint(item);
+
+      if (item->is(NodeKind::Class)) {
+        if (auto base = item->as<NdClass>()->base_class; base)
+          info.base_name = base->name.text;
+      }
+    }
+
+    return infos;
+  }
+
+  bool Sema::is_analyzed(Node* item) const {
+    auto it = item_infos.find(item);
+    return it != item_infos.end() && it->second.analyzed;
+  }
+
+  // items are registered before analysis, so these don't modify item_infos itself.
+  // (called from worker threads of TypeChecker)
+  void Sema::mark_analyzed(Node* item) {
+    if (auto it = item_infos.find(item); it != item_infos.end())
+      it->second.analyzed = true;
+  }
+
+  void Sema::add_dependency(Node* item, std::string_view name) {
+    if (!item)
+      return;
+
+    if (auto it = item_infos.find(item); it != item_infos.end())
+      it->second.deps.emplace(name);
+  }
+
+  bool Sema::is_stale(Scope* scope) const {
+    while (scope->parent)
+      scope = scope->parent;
+
+    return scope != root_scope;
+  }
+
+  bool Sema::refers_to_stale(TypeInfo const& ty) const {
+    if (ty.class_node && is_stale(ty.class_node->scope_ptr))
+      return true;
+
+    if (ty.enum_node && is_stale(ty.enum_node->scope_ptr))
+      return true;
+
+    for (auto& p : ty.parameters) {
+      if (refers_to_stale(p))
+        return true;
+    }
+
+    return false;
+  }
+
+  void Sema::register_items(NdModule* mod) {
+    auto infos = make_item_infos(mod->items);
+
+    for (size_t i = 0; i < mod->items.size(); i++)
+      item_infos[mod->items[i]] = std::move(infos[i]);
+  }
+
+  //
+  // remove links to scopes which are no longer used.
+  void Sema::prune_stale(Scope* scope, Scope* old_root) {
+    if (scope->parent == old_root)
+      scope->parent = root_scope;
+
+    switch (scope->kind) {
+      case ScopeKind::Class: {
+        auto& derived = scope->as<SCClass>()->derived;
+
+        for (size_t i = 0; i < derived.size();) {
+          if (is_stale(derived[i]))
+            derived.erase(derived.begin() + i);
+          else
+            i++;
+        }
+
+        break;
+      }
+
+      case ScopeKind::Namespace:
+        for (auto s : scope->as<SCNamespace>()->classes.symbols)
+          prune_stale(s->scope, old_root);
+        for (auto s : scope->as<SCNamespace>()->namespaces.symbols)
+          prune_stale(s->scope, old_root);
+        break;
+    }
+  }
+
+  std::unordered_map<std::string, Node*> Sema::get_items_by_key() {
+    std::unordered_map<std::string, Node*> old_items;
+
+    for (auto item : cur_module->items)
+      old_items[item_infos[item].key] = item;
+
+    return old_items;
+  }
+
+  std::unordered_set<std::string> Sema::get_dirty_names(
+      std::vector<ItemInfo> const& new_infos,
+      std::unordered_map<std::string, Node*> const& old_items) {
+    //
+    // names of changed items.
+    // a class also invalidates its base, since calls to methods of the base
+    // are devirtualized by looking its subclasses.
+    std::unordered_set<std::string> dirty;
+    std::vector<std::string const*> queue; // names to propagate
+
+    auto add = [&dirty, &queue](std::string const& name) {
+      if (auto [it, ok] = dirty.insert(name); ok)
+        queue.push_back(&*it);
+    };
+
+    auto make_dirty = [&add](ItemInfo const& info) {
+      add(info.name);
+
+      if (!info.base_name.empty())
+        add(info.base_name);
+    };
+
+    std::unordered_set<std::string> new_keys;
+
+    for (auto& info : new_infos) {
+      new_keys.insert(info.key);
+
+      if (auto it = old_items.find(info.key); it == old_items.end()) {
+        make_dirty(info);
+      } else if (auto& old = item_infos.at(it->second);
+                 !old.analyzed || old.fingerprint != info.fingerprint) {
+        make_dirty(old);
+        make_dirty(info);
+      }
+    }
+
+    //
+    // items by name, and items which refer to a name.
+    std::unordered_map<std::string_view, std::vector<ItemInfo const*>> by_name;
+    std::unordered_map<std::string_view, std::vector<ItemInfo const*>> dependents;
+
+    for (auto item : cur_module->items) {
+      auto& info = item_infos[item];
+
+      if (!new_keys.count(info.key))
+        make_dirty(info);
+
+      by_name[info.name].push_back(&info);
+
+      for (auto& dep : info.deps)
+        dependents[dep].push_back(&info);
+    }
+
+    //
+    // dependents of changed items. (transitive)
+    // an item made dirty also invalidates its base.
+    while (!queue.empty()) {
+      std::string_view name = *queue.back();
+      queue.pop_back();
+
+      if (auto it = by_name.find(name); it != by_name.end()) {
+        for (auto info : it->second)
+          make_dirty(*info);
+      }
+
+      if (auto it = dependents.find(name); it != dependents.end()) {
+        for (auto info : it->second)
+          make_dirty(*info);
+      }
+    }
+
+    return dirty;
+  }
+
+  std::vector<Node*> Sema::get_stale_items(std::vector<Node*> const& items) {
+    if (!cur_module)
+      return {};
+
+    auto new_infos = make_item_infos(items, &item_infos);
+    auto old_items = get_items_by_key();
+    auto dirty = get_dirty_names(new_infos, old_items);
+
+    std::vector<Node*> stale;
+
+    for (size_t i = 0; i < items.size(); i++) {
+      if (!item_infos.count(items[i]))
+        continue;
+
+      auto it = old_items.find(new_infos[i].key);
+
+      if (it == old_items.end() || it->second != items[i] || dirty.count(new_infos[i].name))
+        stale.push_back(items[i]);
+    }
+
+    return stale;
+  }
+
+  size_t Sema::reanalyze(NdModule* mod) {
+    if (!cur_module) {
+      analyze_full(mod);
+      return mod->items.size();
+    }
+
+    auto new_infos = make_item_infos(mod->items, &item_infos);
+    auto old_items = get_items_by_key();
+    auto dirty = get_dirty_names(new_infos, old_items);
+
+    //
+    // take over clean items from previous module.
+    // dirty ones are replaced with newly parsed nodes, which have no results of Sema.
+    size_t count = 0;
+    std::unordered_map<Node*, ItemInfo> infos;
+
+    for (size_t i = 0; i < mod->items.size(); i++) {
+      auto& item = mod->items[i];
+
+      if (auto it = old_items.find(new_infos[i].key);
+          it != old_items.end() && !dirty.count(new_infos[i].name)) {
+        if (item == mod->main_fn)
+          mod->main_fn = it->second->as<NdFunction>();
+
+        item = it->second;
+        infos[item] = std::move(item_infos[item]);
+      } else {
+        infos[item] = std::move(new_infos[i]);
+        count++;
+      }
+    }
+
+    item_infos = std::move(infos);
+
+    auto old_root = root_scope;
+
+    cur_module = mod;
+    root_scope = new SCModule(mod, nullptr);
+
+    // instances of top-level templates are children of the root too.
+    for (auto inst : template_instance_list) {
+      if (inst->node->scope_ptr->parent == old_root)
+        inst->node->scope_ptr->parent = root_scope;
+    }
+
+    std::vector<TemplateInstance*> instances;
+
+    template_instances.clear();
+
+    for (auto inst : template_instance_list) {
+      bool stale = is_stale(inst->templ->scope_ptr);
+
+      for (size_t i = 0; !stale && i < inst->args.size(); i++)
+        stale = refers_to_stale(*inst->args[i]);
+
+      if (stale)
+        continue;
+
+      instances.push_back(inst);
+      template_instances[{.templ = inst->templ, .args = inst->args}] = inst;
+    }
+
+    template_instance_list = std::move(instances);
+
+    for (auto s : root_scope->classes.symbols)
+      prune_stale(s->scope, old_root);
+
+    for (auto s : root_scope->namespaces.symbols)
+      prune_stale(s->scope, old_root);
+
+    for (auto inst : template_instance_list) {
+      if (inst->node->is(NodeKind::Class))
+        prune_stale(inst->node->scope_ptr, old_root);
+    }
+
+    NameResolver resolver(*this);
+    {
+      Tracer::Span _span("sema", "resolve names");
+      resolver.on_module(mod, {});
+    }
+
+    TypeChecker checker(*this);
+    {
+      Tracer::Span _span("sema", "check types");
+      checker.check_module(mod, {});
+    }
+
+    return count;
+  }
+
+} // namespace fire
@@ -233,11 +233,15 @@ namespace fire {
       case NodeKind::While: {
         auto x = node->as<NdWhile>();
         ctx.loop_depth++;
+        auto cs = ctx.cur_scope;
+        ctx.cur_scope = x->scope_ptr;
         if (x->vardef)
           on_stmt(x->vardef, ctx);
         if (x->cond)
           on_expr(x->cond, ctx);
         on_stmt(x->body, ctx);
+        ctx.loop_depth--;
+        ctx.cur_scope = cs;
         break;
       }
 
@@ -309,6 +313,16 @@ namespace fire {
     auto C = node->as<NdClass>();
 
     ctx.cur_class = C->scope_ptr->as<SCClass>();
+
+    if (C->base_class) {
+      on_typename(C->base_class, ctx);
+
+      if (auto bs = C->base_class->symbol_ptr; bs && bs->kind == SymbolKind::Class) {
+        ctx.cur_class->base = bs->scope->as<SCClass>();
+        ctx.cur_class->base->derived.push_back(ctx.cur_class);
+      }
+    }
+
     ctx.cur_scope = ctx.cur_class;
 
     for (auto& field : C->fields) {
@@ -317,6 +331,9 @@ namespace fire {
     for (auto& method : C->methods) {
       on_function(method, ctx);
     }
+
+    if (C->m_new)
+      on_function(C->m_new, ctx);
   }
 
   void NameResolver::on_enum(Node* node, NdVisitorContext ctx) {
@@ -372,6 +389,11 @@ namespace fire {
     ctx.cur_scope = modscope;
 
     for (auto& item : M->items) {
+      if (S.is_analyzed(item))
+        continue;
+
+      ctx.cur_item = item;
+
       switch (item->kind) {
         case NodeKind::Let:
           on_stmt(item, ctx);
@@ -10,6 +10,8 @@ namespace fire {
         return new SCIf(node->as<NdIf>(), parent);
       case NodeKind::For:
         return new SCFor(node->as<NdFor>(), parent);
+      case NodeKind::While:
+        return new SCWhile(node->as<NdWhile>(), parent);
       case NodeKind::Catch:
         return new SCCatch(node->as<NdCatch>(), parent);
       case NodeKind::Try:
@@ -60,7 +62,9 @@ namespace fire {
 
         case NodeKind::Scope:
         case NodeKind::For:
+        case NodeKind::While:
         case NodeKind::If:
+        case NodeKind::Try:
           subscopes.push_back(Scope::from_node(item, this));
           break;
       }
@@ -92,6 +96,17 @@ namespace fire {
     body = new SCScope(node->body, this);
   }
 
+  SCWhile::SCWhile(NdWhile* node, Scope* parent) : Scope(ScopeKind::While, node, parent) {
+    node->scope_ptr = this;
+
+    if (node->vardef) {
+      var = Sema::get_instance().new_variable_symbol(node->vardef);
+      node->vardef->symbol_ptr = symtable.append(var);
+    }
+
+    body = new SCScope(node->body, this);
+  }
+
   SCCatch::SCCatch(NdCatch* node, Scope* parent) : Scope(ScopeKind::Catch, node, parent) {
     node->scope_ptr = this;
 
@@ -110,15 +125,7 @@ namespace fire {
     body = new SCScope(node->body, this);
 
     for (auto& catch_node : node->catches) {
-      auto cc = new SCCatch(catch_node, this);
-
-      cc->holder_name =
-          Sema::get_instance().new_variable_symbol(&catch_node->holder, catch_node->holder.text);
-
-      cc->symtable.append(cc->holder_name);
-      cc->body = new SCScope(catch_node->body, cc);
-
-      catches.push_back(cc);
+      catches.push_back(new SCCatch(catch_node, this));
     }
 
     if (node->finally_block) {
@@ -185,7 +192,7 @@ namespace fire {
     };
 
     for (auto& field : node->fields) {
-      fields.append(Sema::get_instance().new_variable_symbol(field));
+      field->symbol_ptr = fields.append(Sema::get_instance().new_variable_symbol(field));
     }
 
     for (auto& method : node->methods) {
@@ -193,6 +200,9 @@ namespace fire {
       symtable.append(&scope->symbol);
       methods.append(&scope->symbol);
     }
+
+    if (node->m_new)
+      new SCFunction(node->m_new, this);
   }
 
   SCNamespace::SCNamespace(NdNamespace* node, Scope* parent)
@@ -231,15 +241,19 @@ namespace fire {
         .scope = this,
     };
 
+    // items taken over from previous analysis keep their symbol and scope.
     for (auto& item : node->items) {
       if (item->is(NodeKind::Let)) {
         auto let = item->as<NdLet>();
-        auto s = variables.append(Sema::get_instance().new_variable_symbol(let));
+        auto s = let->symbol_ptr ? let->symbol_ptr
+                                 : Sema::get_instance().new_variable_symbol(let);
+        variables.append(s);
         symtable.append(s);
         let->symbol_ptr = s;
         assert(let->symbol_ptr);
       } else {
-        auto scope = Scope::from_node(item, this);
+        auto scope = item->scope_ptr ? item->scope_ptr : Scope::from_node(item, this);
+        scope->parent = this;
         symtable.append(&scope->symbol);
         get_table(item->kind)->append(&scope->symbol);
       }
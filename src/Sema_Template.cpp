@@ -0,0 +1,331 @@
+#include "Utils.hpp"
+#include "Error.hpp"
+#include "Sema.hpp"
+
+namespace fire {
+
+  //
+  // make a deep copy of the syntax tree.
+  // results of Sema (scope_ptr, ty, symbol_ptr, ...) are not copied.
+  //
+  static Node* clone_node(Node* node);
+
+  template <typename T>
+  static T* clone(T* node) {
+    return node ? static_cast<T*>(clone_node(node)) : nullptr;
+  }
+
+  template <typename T>
+  static std::vector<T*> clone_all(std::vector<T*> const& v) {
+    std::vector<T*> ret;
+    for (auto x : v)
+      ret.push_back(clone(x));
+    return ret;
+  }
+
+  static NdFunction* clone_function(NdFunction* node) {
+    auto x = new NdFunction(node->token, node->name);
+
+    for (auto& arg : node->args)
+      x->args.emplace_back(arg.name, clone(arg.type));
+
+    x->result_type = clone(node->result_type);
+    x->body = clone(node->body);
+    x->take_self = node->take_self;
+    x->is_pub = node->is_pub;
+
+    return x;
+  }
+
+  static Node* clone_node(Node* node) {
+    switch (node->kind) {
+      case NodeKind::Value:
+        return new NdValue(node->token, node->as<NdValue>()->obj, node->as<NdValue>()->const_index);
+
+      case NodeKind::Symbol: {
+        auto s = node->as<NdSymbol>();
+        auto x = new NdSymbol(s->token);
+
+        x->name = s->name;
+        x->dec = clone(s->dec);
+        x->te_args = clone_all(s->te_args);
+        x->scope_resol_tok = s->scope_resol_tok;
+        x->next = clone(s->next);
+        x->is_ref = s->is_ref;
+        x->is_const = s->is_const;
+        x->concept_nd = clone(s->concept_nd);
+
+        return x;
+      }
+
+      case NodeKind::KeyValuePair: {
+        auto kv = node->as<NdKeyValuePair>();
+        return new NdKeyValuePair(kv->token, clone(kv->key), clone(kv->value));
+      }
+
+      case NodeKind::Self:
+        return new NdSelf(node->token);
+
+      case NodeKind::DeclType:
+        return new NdDeclType(node->token, clone(node->as<NdDeclType>()->expr));
+
+      case NodeKind::Array: {
+        auto x = new NdArray(node->token);
+        x->data = clone_all(node->as<NdArray>()->data);
+        return x;
+      }
+
+      case NodeKind::Tuple: {
+        auto x = new NdTuple(node->token);
+        x->elems = clone_all(node->as<NdTuple>()->elems);
+        return x;
+      }
+
+      case NodeKind::CallFunc: {
+        auto cf = node->as<NdCallFunc>();
+        auto x = new NdCallFunc(clone(cf->callee), cf->token);
+
+        x->args = clone_all(cf->args);
+        x->is_method_call = cf->is_method_call;
+        x->inst_expr = clone(cf->inst_expr);
+
+        return x;
+      }
+
+      case NodeKind::GetTupleElement: {
+        auto ge = node->as<NdGetTupleElement>();
+        auto x = new NdGetTupleElement(ge->token, clone(ge->expr), ge->index);
+        x->index_tok = ge->index_tok;
+        return x;
+      }
+
+      case NodeKind::Inclement: {
+        auto inc = node->as<NdInclement>();
+        return new NdInclement(inc->token, clone(inc->expr), inc->is_postfix);
+      }
+
+      case NodeKind::Declement: {
+        auto dec = node->as<NdDeclement>();
+        return new NdDeclement(dec->token, clone(dec->expr), dec->is_postfix);
+      }
+
+      case NodeKind::New: {
+        auto nw = node->as<NdNew>();
+        auto x = new NdNew(nw->token);
+        x->type = clone(nw->type);
+        x->args = clone_all(nw->args);
+        return x;
+      }
+
+      case NodeKind::Ref: {
+        auto x = new NdRef(node->token);
+        x->expr = clone(node->as<NdRef>()->expr);
+        return x;
+      }
+
+      case NodeKind::Deref: {
+        auto x = new NdDeref(node->token);
+        x->expr = clone(node->as<NdDeref>()->expr);
+        return x;
+      }
+
+      case NodeKind::BitNot: {
+        auto x = new NdBitNot(node->token);
+        x->expr = clone(node->as<NdBitNot>()->expr);
+        return x;
+      }
+
+      case NodeKind::AssignWithOp: {
+        auto a = node->as<NdAssignWithOp>();
+        return new NdAssignWithOp(a->opkind, a->token, clone(a->lhs), clone(a->rhs));
+      }
+
+      case NodeKind::Scope: {
+        auto x = new NdScope(node->token);
+        x->items = clone_all(node->as<NdScope>()->items);
+        return x;
+      }
+
+      case NodeKind::Let: {
+        auto let = node->as<NdLet>();
+        auto x = new NdLet(let->token, let->name);
+
+        x->is_static = let->is_static;
+        x->placeholders = let->placeholders;
+        x->type = clone(let->type);
+        x->init = clone(let->init);
+        x->is_pub = let->is_pub;
+
+        return x;
+      }
+
+      case NodeKind::Catch: {
+        auto c = node->as<NdCatch>();
+        auto x = new NdCatch(c->token);
+
+        x->holder = c->holder;
+        x->error_type = clone(c->error_type);
+        x->body = clone(c->body);
+
+        return x;
+      }
+
+      case NodeKind::Try: {
+        auto t = node->as<NdTry>();
+        auto x = new NdTry(t->token);
+
+        x->body = clone(t->body);
+        x->catches = clone_all(t->catches);
+        x->finally_block = clone(t->finally_block);
+
+        return x;
+      }
+
+      case NodeKind::If: {
+        auto i = node->as<NdIf>();
+        auto x = new NdIf(i->token);
+
+        x->vardef = clone(i->vardef);
+        x->cond = clone(i->cond);
+        x->thencode = clone(i->thencode);
+        x->elsecode = clone(i->elsecode);
+
+        return x;
+      }
+
+      case NodeKind::For: {
+        auto f = node->as<NdFor>();
+        auto x = new NdFor(f->token);
+
+        x->iter = f->iter;
+        x->iterable = clone(f->iterable);
+        x->body = clone(f->body);
+
+        return x;
+      }
+
+      case NodeKind::While: {
+        auto w = node->as<NdWhile>();
+        auto x = new NdWhile(w->token);
+
+        x->vardef = clone(w->vardef);
+        x->cond = clone(w->cond);
+        x->body = clone(w->body);
+
+        return x;
+      }
+
+      case NodeKind::Return: {
+        auto x = new NdReturn(node->token);
+        x->expr = clone(node->as<NdReturn>()->expr);
+        return x;
+      }
+
+      case NodeKind::Break:
+      case NodeKind::Continue:
+        return new NdBreakOrContinue(node->kind, node->token);
+
+      case NodeKind::Function:
+        return clone_function(node->as<NdFunction>());
+
+      case NodeKind::Class: {
+        auto C = node->as<NdClass>();
+        auto x = new NdClass(C->token, C->name);
+
+        x->base_class = clone(C->base_class);
+        x->fields = clone_all(C->fields);
+
+        for (auto M : C->methods)
+          x->methods.push_back(clone_function(M));
+
+        if (C->m_new)
+          x->m_new = clone_function(C->m_new);
+
+        if (C->m_delete)
+          x->m_delete = clone_function(C->m_delete);
+
+        return x;
+      }
+
+      default:
+        break;
+    }
+
+    // binary expressions.
+    // ("!=" is also NdExpr with NodeKind::Not)
+    if (auto ex = dynamic_cast<NdExpr*>(node); ex) {
+      return new NdExpr(ex->kind, ex->token, clone(ex->lhs), clone(ex->rhs));
+    }
+
+    if (node->is(NodeKind::Not)) {
+      auto x = new NdNot(node->token);
+      x->expr = clone(node->as<NdNot>()->expr);
+      return x;
+    }
+
+    todo;
+  }
+
+  std::string TemplateInstance::get_name() const {
+    std::string name{templ->is(NodeKind::Function) ? templ->as<NdFunction>()->name.text
+                                                   : templ->as<NdClass>()->name.text};
+
+    return name + "<" + join(", ", args, [](TypeInfo const* t) { return t->to_string(); }) + ">";
+  }
+
+  TemplateInstance* Sema::instantiate(NdTemplatableBase* templ, std::vector<TypeInfo> const& args,
+                                      Token const& tok) {
+    if ((int)args.size() != templ->count()) {
+      throw err::no_match_template_arguments(tok, templ->count(), (int)args.size());
+    }
+
+    std::lock_guard<std::recursive_mutex> lock(instance_mtx);
+
+    TemplateInstanceKey key{.templ = templ};
+
+    for (auto& arg : args)
+      key.args.push_back(TypeInfo::intern(arg));
+
+    if (auto it = template_instances.find(key); it != template_instances.end())
+      return it->second;
+
+    auto inst = new TemplateInstance{.templ = templ, .args = key.args};
+
+    inst->node = clone_node(templ)->as<NdTemplatableBase>();
+    inst->node->template_origin = templ;
+    inst->node->template_args = args;
+
+    // register before checking, so that recursive use finds this instance.
+    template_instances[key] = inst;
+    template_instance_list.push_back(inst);
+
+    auto parent = templ->scope_ptr->parent;
+    auto scope = Scope::from_node(inst->node, parent);
+
+    for (int i = 0; i < templ->count(); i++) {
+      scope->symtable.append(new Symbol{
+          .name = std::string(templ->parameter_defs[i]->name.text),
+          .kind = SymbolKind::TemplateParam,
+          .type = args[i],
+          .node = templ->parameter_defs[i],
+      });
+    }
+
+    NdVisitorContext ctx = {};
+    ctx.cur_scope = parent;
+
+    NameResolver resolver(*this);
+    TypeChecker checker(*this);
+
+    if (inst->node->is(NodeKind::Function)) {
+      resolver.on_function(inst->node, ctx);
+      checker.check_function(inst->node->as<NdFunction>(), ctx);
+    } else {
+      resolver.on_class(inst->node, ctx);
+      checker.check_class(inst->node->as<NdClass>(), ctx);
+    }
+
+    return inst;
+  }
+
+} // namespace fire
@@ -1,8 +1,12 @@
+#include <algorithm>
+
 #include "Utils.hpp"
 #include "Error.hpp"
 #include "Node.hpp"
 #include "Sema.hpp"
 #include "BuiltinFunc.hpp"
+#include "VM.hpp"
+#include "Trace.hpp"
 
 #define PRINT_LOCATION(TOK) (err::e(TOK, "node").print())
 
@@ -33,7 +37,7 @@ namespace fire {
       result.flags |= ArgumentsCompareResult::TooFew;
     }
 
-    for(size_t i = 0; i < defs.size(); i++){
+    for(size_t i = 0; i < std::min(defs.size(), actual.size()); i++){
       if(defs[i].kind == TypeKind::Any){
         continue;
       }
@@ -67,6 +71,7 @@ namespace fire {
 
     ctx.as_callee_of_callfunc = true;
     ctx.parent_cf_nd = cf;
+    ctx.arg_types_ptr = &arg_types;
 
     if(cf->is_method_call){
       self_ty = eval_expr_ty(cf->inst_expr, ctx);
@@ -75,31 +80,29 @@ namespace fire {
       std::string const method_name { cf->callee->token.text };
 
       if(self_ty.is(TypeKind::Class) || self_ty.is(TypeKind::Enum)){
-        todo;
+        return case_method_call(cf, self_ty, arg_types, ctx);
       }
 
-      for(BuiltinFunc const* method : builtin_method_table ){
-        if(method->name == method_name && method->self_type.kind == self_ty.kind){
-          auto cmp = compare_arguments(
-            cf, nullptr, method, method->is_var_args, true, self_ty, method->arg_types, arg_types);
+      if(auto method = BuiltinRegistry::get_instance().find_method(self_ty.kind, method_name); method){
+        auto cmp = compare_arguments(
+          cf, nullptr, method, method->is_var_args, true, self_ty, method->arg_types, arg_types);
 
-          if(cmp.flags & ArgumentsCompareResult::TypeMismatch){
-            throw err::mismatched_types(cf->args[cmp.mismatched_index]->token,
-                method->arg_types[cmp.mismatched_index].to_string(), arg_types[cmp.mismatched_index].to_string());
-          }
+        if(cmp.flags & ArgumentsCompareResult::TypeMismatch){
+          throw err::mismatched_types(cf->args[cmp.mismatched_index]->token,
+              method->arg_types[cmp.mismatched_index].to_string(), arg_types[cmp.mismatched_index].to_string());
+        }
 
-          if(cmp.flags & ArgumentsCompareResult::TooMany){
-            throw err::too_many_arguments(cf->args[cmp.mismatched_index]->token);
-          }
+        if(cmp.flags & ArgumentsCompareResult::TooMany){
+          throw err::too_many_arguments(cf->args[method->arg_types.size()]->token);
+        }
 
-          if(cmp.flags & ArgumentsCompareResult::TooFew){
-            throw err::too_few_arguments(cf->args[cmp.mismatched_index]->token);
-          }
+        if(cmp.flags & ArgumentsCompareResult::TooFew){
+          throw err::too_few_arguments(cf->token);
+        }
 
-          cf->ty = method->returning_self ? self_ty : method->result_type;
+        cf->ty = method->returning_self ? self_ty : method->result_type;
 
-          return cf->ty;
-        }
+        return cf->ty;
       }
 
       throw err::e(cf->callee->token, "method '" + method_name + "' not found in '" + self_ty.to_string() + "'");
@@ -108,8 +111,40 @@ namespace fire {
 
     auto callee_ty = eval_expr_ty(cf->callee, ctx); // callee_ty = { result_type, [args...] }
 
+    // constructor
     if (callee_ty.is(TypeKind::Class)) {
-      todo;
+      auto C = callee_ty.class_node;
+
+      get_class_layout(C);
+
+      cf->construct_class = C;
+      cf->func_nd = C->m_new;
+
+      std::vector<TypeInfo> defs;
+
+      if (C->m_new) {
+        ctx = {};
+        for (auto& arg : C->m_new->args)
+          defs.push_back(eval_typename_ty(arg.type, ctx));
+      }
+
+      auto cmp = compare_arguments(cf, C->m_new, nullptr, false, false, callee_ty, defs, arg_types);
+
+      if (cmp.flags & ArgumentsCompareResult::TooMany) {
+        throw err::too_many_arguments(cf->args[defs.size()]->token);
+      }
+
+      if (cmp.flags & ArgumentsCompareResult::TooFew) {
+        throw err::too_few_arguments(cf->token);
+      }
+
+      if (cmp.flags & ArgumentsCompareResult::TypeMismatch) {
+        throw err::mismatched_types(cf->args[cmp.mismatched_index]->token,
+                                    defs[cmp.mismatched_index].to_string(),
+                                    arg_types[cmp.mismatched_index].to_string());
+      }
+
+      return cf->ty = callee_ty;
     }
 
     if (callee_ty.is(TypeKind::Enum))
@@ -125,24 +160,106 @@ namespace fire {
       throw err::too_many_arguments(cf->args[argc_take]->token);
     }
     else if(argc_take > argc_give) {
-      throw err::too_few_arguments(cf->args[argc_take]->token);
+      throw err::too_few_arguments(cf->token);
     }
 
     for (size_t i = 0; i < argc_take; i++) {
       if (!arg_types[i].equals(callee_ty.parameters[i + 1])) {
-        todo; // argument type mismatch
+        throw err::mismatched_types(cf->args[i]->token, callee_ty.parameters[i + 1].to_string(),
+                                    arg_types[i].to_string());
       }
     }
 
+    if (auto sym = cf->callee->as<NdSymbol>(); cf->callee->is(NodeKind::Symbol) && sym->sym_target &&
+                                               sym->sym_target->is(NodeKind::Function)) {
+      cf->func_nd = sym->sym_target->as<NdFunction>();
+    }
+
     cf->ty = callee_ty.parameters[0];
 
     return cf->ty;
   }
 
-  TypeInfo TypeChecker::case_method_call(NdCallFunc* cf, NdVisitorContext ctx) {
-    (void)cf;
-    (void)ctx;
-    todo;
+  TypeInfo TypeChecker::case_method_call(NdCallFunc* cf, TypeInfo& self_ty,
+                                         std::vector<TypeInfo>& arg_types, NdVisitorContext ctx) {
+    std::string const method_name{cf->callee->token.text};
+
+    NdFunction* method = nullptr;
+    SCClass* C = nullptr;
+
+    if (self_ty.is(TypeKind::Class)) {
+      C = self_ty.class_node->scope_ptr->as<SCClass>();
+      method = find_method(C, method_name);
+    }
+
+    if (!method) {
+      throw err::e(cf->callee->token,
+                   "method '" + method_name + "' not found in '" + self_ty.to_string() + "'");
+    }
+
+    ctx = {};
+
+    std::vector<TypeInfo> defs;
+
+    for (auto& arg : method->args)
+      defs.push_back(eval_typename_ty(arg.type, ctx));
+
+    auto cmp = compare_arguments(cf, method, nullptr, false, true, self_ty, defs, arg_types);
+
+    if (cmp.flags & ArgumentsCompareResult::TooMany) {
+      throw err::too_many_arguments(cf->args[defs.size()]->token);
+    }
+
+    if (cmp.flags & ArgumentsCompareResult::TooFew) {
+      throw err::too_few_arguments(cf->token);
+    }
+
+    if (cmp.flags & ArgumentsCompareResult::TypeMismatch) {
+      throw err::mismatched_types(cf->args[cmp.mismatched_index]->token,
+                                  defs[cmp.mismatched_index].to_string(),
+                                  arg_types[cmp.mismatched_index].to_string());
+    }
+
+    cf->func_nd = method;
+
+    // the static type of receiver is known.
+    // only when a subclass overrides the method, it must be dispatched at run time.
+    if (is_overridden(C, method_name)) {
+      cf->is_virtual = true;
+      cf->inline_cache = new VM::InlineCache(cf, method_name);
+    }
+
+    cf->ty = method->result_type ? eval_typename_ty(method->result_type, ctx) : TypeInfo();
+
+    return cf->ty;
+  }
+
+  NdFunction* TypeChecker::find_method(SCClass* C, std::string_view name) {
+    for (; C; C = C->base) {
+      for (auto M : C->get_node()->methods) {
+        if (M->name.text == name)
+          return M;
+      }
+    }
+
+    return nullptr;
+  }
+
+  bool TypeChecker::is_overridden(SCClass* C, std::string_view name) {
+    // instantiation of a class template may add a subclass.
+    std::lock_guard<std::recursive_mutex> lock(S.instance_mtx);
+
+    for (auto D : C->derived) {
+      for (auto M : D->get_node()->methods) {
+        if (M->name.text == name)
+          return true;
+      }
+
+      if (is_overridden(D, name))
+        return true;
+    }
+
+    return false;
   }
 
   TypeInfo TypeChecker::case_construct_enumerator(NdCallFunc* cf, NdEnumeratorDef* en_def, TypeInfo& callee_ty, size_t argc_give, std::vector<TypeInfo>& arg_types, NdVisitorContext ctx) {
@@ -237,8 +354,20 @@ namespace fire {
             node->ty = sym->symbol_ptr->var_info->type;
             break;
 
-          case SymbolKind::Func:
-            todo;
+          case SymbolKind::Func: {
+            auto fn = sym->symbol_ptr->node->as<NdFunction>();
+
+            if (fn->is_template()) {
+              fn = S.instantiate(fn, get_template_args(fn, sym, ctx), sym->token)
+                       ->node->as<NdFunction>();
+            } else if (!sym->te_args.empty()) {
+              throw err::no_match_template_arguments(sym->token, 0, (int)sym->te_args.size());
+            }
+
+            sym->sym_target = fn;
+            node->ty = make_function_type(fn);
+            break;
+          }
 
           case SymbolKind::Enumerator: {
             auto en = sym->symbol_ptr->node->as<NdEnumeratorDef>();
@@ -368,11 +497,35 @@ namespace fire {
         auto obj_ty = eval_expr_ty(mm->lhs, ctx);
 
         if (obj_ty.class_node == nullptr) {
-          PRINT_LOCATION(mm->lhs->token);
-          todo; // not instance.
+          throw err::semantics::expected_class_type(mm->lhs->token);
         }
 
-        todo;
+        if (!mm->rhs->is(NodeKind::Symbol)) {
+          PRINT_LOCATION(mm->rhs->token);
+          todo;
+        }
+
+        auto name = mm->rhs->as<NdSymbol>();
+        auto field = get_class_layout(obj_ty.class_node)->find_field(name->name.text);
+
+        if (!field) {
+          throw err::semantics::not_field_of_class(name->token, std::string(name->name.text),
+                                                   obj_ty.to_string());
+        }
+
+        // a.b --> load slot of constant offset
+        name->sym_target = field->node;
+        name->var_offset = (int)field->offset;
+
+        if (auto vi = field->node->symbol_ptr->var_info; vi->is_type_deducted) {
+          node->ty = vi->type;
+        } else if (field->node->type) {
+          node->ty = eval_typename_ty(field->node->type, {});
+        } else {
+          node->ty = eval_expr_ty(field->node->init, {});
+        }
+
+        break;
       }
 
       case NodeKind::GetTupleElement: {
@@ -415,11 +568,37 @@ namespace fire {
       }
 
       case NodeKind::Assign: {
-        todo;
+        auto ex = node->as<NdExpr>();
+
+        auto lhs_ty = eval_expr_ty(ex->lhs, ctx);
+        auto rhs_ty = eval_expr_ty(ex->rhs, ctx);
+
+        if (!lhs_ty.equals(rhs_ty))
+          throw err::mismatched_types(ex->rhs->token, lhs_ty.to_string(), rhs_ty.to_string());
+
+        if (ex->rhs->is(NodeKind::Add))
+          ex->use_builder = is_string_append_in_loop(ex->lhs, ex->rhs->as<NdExpr>()->lhs, lhs_ty, ctx);
+
+        node->ty = lhs_ty;
+        break;
       }
 
       case NodeKind::AssignWithOp: {
-        todo;
+        auto aw = node->as<NdAssignWithOp>();
+
+        auto lhs_ty = eval_expr_ty(aw->lhs, ctx);
+        auto rhs_ty = eval_expr_ty(aw->rhs, ctx);
+
+        auto res_ty = eval_binary_ty(aw->opkind, aw->token, lhs_ty, rhs_ty);
+
+        if (!lhs_ty.equals(res_ty))
+          throw err::mismatched_types(aw->rhs->token, lhs_ty.to_string(), res_ty.to_string());
+
+        if (aw->opkind == NodeKind::Add)
+          aw->use_builder = is_string_append_in_loop(aw->lhs, aw->lhs, lhs_ty, ctx);
+
+        node->ty = lhs_ty;
+        break;
       }
 
       default: {
@@ -430,9 +609,7 @@ namespace fire {
         auto lhs_ty = eval_expr_ty(ex->lhs, ctx);
         auto rhs_ty = eval_expr_ty(ex->rhs, ctx);
 
-        // todo: check operators ...
-
-        node->ty = lhs_ty;
+        node->ty = eval_binary_ty(ex->kind, ex->token, lhs_ty, rhs_ty);
         break;
       }
     }
@@ -441,10 +618,51 @@ namespace fire {
     return node->ty;
   }
 
+  TypeInfo TypeChecker::eval_binary_ty(NodeKind op, Token const& tok, TypeInfo const& lhs_ty,
+                                       TypeInfo const& rhs_ty) {
+    // string + string, string + char
+    if (lhs_ty.is(TypeKind::String) && op == NodeKind::Add) {
+      if (!rhs_ty.is(TypeKind::String) && !rhs_ty.is(TypeKind::Char))
+        throw err::mismatched_types(tok, "string or char", rhs_ty.to_string());
+
+      return lhs_ty;
+    }
+
+    // todo: check operators ...
+
+    return lhs_ty;
+  }
+
+  //
+  // candidates to hold the variable in a StringBuilder while the loop runs,
+  // so that appending is amortized O(1). (only marked, see StringBuilder)
+  // loops are "for" and "while".
+  //
+  // rhs_lhs is lhs of "+" in "s = s + x", or s itself in "s += x".
+  bool TypeChecker::is_string_append_in_loop(Node* lhs, Node* rhs_lhs, TypeInfo const& lhs_ty,
+                                             NdVisitorContext const& ctx) {
+    if (ctx.loop_depth == 0 || !lhs_ty.is(TypeKind::String))
+      return false;
+
+    if (!lhs->is(NodeKind::Symbol) || !rhs_lhs->is(NodeKind::Symbol))
+      return false;
+
+    auto a = lhs->as<NdSymbol>()->symbol_ptr;
+    auto b = rhs_lhs->as<NdSymbol>()->symbol_ptr;
+
+    return a && b && a->kind == SymbolKind::Var && b->kind == SymbolKind::Var &&
+           a->var_info == b->var_info;
+  }
+
   TypeInfo TypeChecker::eval_typename_ty(NdSymbol* node, NdVisitorContext ctx) {
     (void)node;
     (void)ctx;
 
+    // signatures are evaluated before function bodies;
+    // bodies checked in parallel only read them.
+    if (node->ty_evaluated)
+      return node->ty;
+
     switch (node->kind) {
       case NodeKind::Symbol: {
         auto sym = node->as<NdSymbol>();
@@ -459,8 +677,23 @@ namespace fire {
             return make_enum_type(sym->symbol_ptr->node->as<NdEnum>());
           }
 
-          case SymbolKind::Class:
-            todo;
+          case SymbolKind::Class: {
+            auto C = sym->symbol_ptr->node->as<NdClass>();
+
+            if (C->is_template()) {
+              std::vector<TypeInfo> args;
+
+              for (auto p : sym->te_args)
+                args.push_back(eval_typename_ty(p, ctx));
+
+              C = S.instantiate(C, args, sym->token)->node->as<NdClass>();
+            } else if (!sym->te_args.empty()) {
+              throw err::no_match_template_arguments(sym->token, 0, (int)sym->te_args.size());
+            }
+
+            node->ty = make_class_type(C);
+            break;
+          }
 
           case SymbolKind::BuiltinType: {
             TypeInfo ty = sym->symbol_ptr->type;
@@ -494,7 +727,8 @@ namespace fire {
           }
 
           case SymbolKind::TemplateParam:
-            todo;
+            node->ty = sym->symbol_ptr->type;
+            break;
 
           default:
             err::emitters::expected_type_name_here(node->token);
@@ -519,6 +753,102 @@ namespace fire {
     return type;
   }
 
+  TypeInfo TypeChecker::make_function_type(NdFunction* node) {
+    auto type = TypeInfo(TypeKind::Function);
+
+    type.parameters.push_back(node->result_type ? eval_typename_ty(node->result_type, {})
+                                                : TypeInfo());
+
+    for (auto& arg : node->args)
+      type.parameters.push_back(eval_typename_ty(arg.type, {}));
+
+    return type;
+  }
+
+  std::vector<TypeInfo> TypeChecker::get_template_args(NdTemplatableBase* templ, NdSymbol* sym,
+                                                       NdVisitorContext ctx) {
+    std::vector<TypeInfo> args;
+
+    if (!sym->te_args.empty()) {
+      for (auto p : sym->te_args)
+        args.push_back(eval_typename_ty(p, ctx));
+
+      return args;
+    }
+
+    // deduce from arguments:
+    //   fn f<T>(a: T, b: Vec<T>) ...
+    //   f(1, [2])  --> T = int
+    std::vector<TypeInfo const*> deduced(templ->count(), nullptr);
+
+    if (templ->is(NodeKind::Function) && ctx.parent_cf_nd && ctx.arg_types_ptr) {
+      auto fn = templ->as<NdFunction>();
+      auto cf = ctx.parent_cf_nd;
+      auto& arg_types = *ctx.arg_types_ptr;
+
+      for (size_t i = 0; i < fn->args.size() && i < arg_types.size(); i++) {
+        if (!deduce_template_arg(fn->args[i].type, arg_types[i], templ, deduced)) {
+          throw err::mismatched_types(cf->args[i]->token, node2s(fn->args[i].type),
+                                      arg_types[i].to_string());
+        }
+      }
+    }
+
+    for (int i = 0; i < templ->count(); i++) {
+      if (!deduced[i]) {
+        throw err::e(sym->token, "cannot deduce template parameter '" +
+                                     templ->parameter_defs[i]->name.text + "'");
+      }
+
+      args.push_back(*deduced[i]);
+    }
+
+    return args;
+  }
+
+  bool TypeChecker::deduce_template_arg(NdSymbol* pattern, TypeInfo const& actual,
+                                        NdTemplatableBase* templ,
+                                        std::vector<TypeInfo const*>& out) {
+    if (pattern->is_single() && pattern->te_args.empty()) {
+      for (int i = 0; i < templ->count(); i++) {
+        if (templ->parameter_defs[i]->name.text != pattern->name.text)
+          continue;
+
+        auto ty = TypeInfo::intern(actual);
+
+        if (out[i] && out[i] != ty)
+          return false;
+
+        out[i] = ty;
+        return true;
+      }
+    }
+
+    if (pattern->te_args.size() == actual.parameters.size()) {
+      for (size_t i = 0; i < pattern->te_args.size(); i++) {
+        if (!deduce_template_arg(pattern->te_args[i], actual.parameters[i], templ, out))
+          return false;
+      }
+    }
+
+    return true;
+  }
+
+  VM::ClassLayout* TypeChecker::get_class_layout(NdClass* node) {
+    if (node->layout)
+      return node->layout;
+
+    if (node->base_class) {
+      if (!eval_typename_ty(node->base_class, {}).is(TypeKind::Class)) {
+        throw err::semantics::expected_class_type(node->base_class->token);
+      }
+
+      get_class_layout(node->base_class->ty.class_node);
+    }
+
+    return VM::ClassLayout::of(node);
+  }
+
   TypeInfo TypeChecker::make_enum_type(NdEnum* node) {
     auto type = TypeInfo(TypeKind::Enum);
 
@@ -581,6 +911,33 @@ namespace fire {
         break;
       }
 
+      case NodeKind::Try: {
+        auto try_ = node->as<NdTry>();
+        auto cs = ctx.cur_scope;
+        auto tryscope = try_->scope_ptr->as<SCTry>();
+
+        ctx.cur_scope = tryscope;
+        check_scope(try_->body, ctx);
+
+        for (size_t i = 0; i < try_->catches.size(); i++) {
+          auto catch_ = try_->catches[i];
+          auto catchscope = tryscope->catches[i];
+
+          catchscope->holder_name->var_info->type = eval_typename_ty(catch_->error_type, ctx);
+          catchscope->holder_name->var_info->is_type_deducted = true;
+
+          ctx.cur_scope = catchscope;
+          check_scope(catch_->body, ctx);
+          ctx.cur_scope = tryscope;
+        }
+
+        if (try_->finally_block)
+          check_scope(try_->finally_block, ctx);
+
+        ctx.cur_scope = cs;
+        break;
+      }
+
       case NodeKind::Match: {
         todo;
       }
@@ -620,21 +977,36 @@ namespace fire {
       }
 
       case NodeKind::While: {
-        todo;
-      }
+        auto while_ = node->as<NdWhile>();
+        auto cs = ctx.cur_scope;
 
-      case NodeKind::Loop: {
-        todo;
-      }
+        ctx.loop_depth++;
+        ctx.cur_scope = while_->scope_ptr->as<SCWhile>();
 
-      case NodeKind::Break: {
-        todo;
+        if (while_->vardef)
+          check_stmt(while_->vardef, ctx);
+
+        if (while_->cond)
+          check_expr(while_->cond, ctx);
+
+        check_scope(while_->body, ctx);
+
+        ctx.cur_scope = cs;
+        ctx.loop_depth--;
+
+        break;
       }
 
-      case NodeKind::Continue: {
+      case NodeKind::Loop: {
+        // not parsed yet.
         todo;
       }
 
+      // places are checked by NameResolver.
+      case NodeKind::Break:
+      case NodeKind::Continue:
+        break;
+
       case NodeKind::Return: {
         todo;
       }
@@ -664,10 +1036,12 @@ namespace fire {
   }
 
   void TypeChecker::check_function(NdFunction* node, NdVisitorContext ctx) {
+    check_function_signature(node, ctx);
+    check_function_body(node, ctx);
+  }
 
-    auto fn_scope = node->scope_ptr->as<SCFunction>();
-
-    (void)fn_scope;
+  void TypeChecker::check_function_signature(NdFunction* node, NdVisitorContext ctx) {
+    ctx.cur_func = node->scope_ptr->as<SCFunction>();
 
     for (auto& arg : node->args) {
       arg.type->ty = eval_typename_ty(arg.type, ctx);
@@ -681,16 +1055,76 @@ namespace fire {
       node->result_type->ty = eval_typename_ty(node->result_type, ctx);
       node->result_type->ty_evaluated = true;
     }
+  }
+
+  void TypeChecker::check_function_body(NdFunction* node, NdVisitorContext ctx) {
+    Tracer::Span _span("check_function", node->name.text, node->token.source->path);
+
+    auto fn_scope = node->scope_ptr->as<SCFunction>();
+
+    ctx.cur_func = fn_scope;
+    ctx.in_method = ctx.cur_class && node->take_self;
 
     check_scope(node->body, ctx);
   }
 
   void TypeChecker::check_class(NdClass* node, NdVisitorContext ctx) {
-    (void)node;(void)ctx;
+    check_class_signature(node, ctx);
+    check_class_body(node, ctx);
+  }
+
+  void TypeChecker::check_class_signature(NdClass* node, NdVisitorContext ctx) {
+    ctx.cur_class = node->scope_ptr->as<SCClass>();
+
+    get_class_layout(node);
+
+    ctx.cur_scope = ctx.cur_class;
+
+    for (auto& field : node->fields) {
+      check_stmt(field, ctx);
+    }
+
+    for (auto& method : node->methods) {
+      check_function_signature(method, ctx);
+    }
+
+    if (node->m_new)
+      check_function_signature(node->m_new, ctx);
+  }
+
+  void TypeChecker::check_class_body(NdClass* node, NdVisitorContext ctx) {
+    ctx.cur_class = node->scope_ptr->as<SCClass>();
+    ctx.cur_scope = ctx.cur_class;
+
+    for (auto& method : node->methods) {
+      check_function_body(method, ctx);
+    }
+
+    if (node->m_new)
+      check_function_body(node->m_new, ctx);
   }
 
+  // types of variants are evaluated here, before checking function bodies.
   void TypeChecker::check_enum(NdEnum* node, NdVisitorContext ctx) {
-    (void)node;(void)ctx;
+    ctx.cur_scope = node->scope_ptr;
+
+    for (auto en : node->enumerators) {
+      switch (en->type) {
+        case NdEnumeratorDef::OneType:
+          eval_typename_ty(en->variant, ctx);
+          break;
+
+        case NdEnumeratorDef::MultipleTypes:
+          for (auto t : en->multiple)
+            eval_typename_ty(t->as<NdSymbol>(), ctx);
+          break;
+
+        case NdEnumeratorDef::StructFields:
+          for (auto t : en->multiple)
+            eval_typename_ty(t->as<NdKeyValuePair>()->value->as<NdSymbol>(), ctx);
+          break;
+      }
+    }
   }
 
   void TypeChecker::check_namespace(NdNamespace* node, NdVisitorContext ctx) {
@@ -701,6 +1135,47 @@ namespace fire {
         case NodeKind::Let:
           check_stmt(item, ctx);
           break;
+
+        case NodeKind::Function:
+          if (!item->as<NdFunction>()->is_template())
+            check_function_signature(item->as<NdFunction>(), ctx);
+          break;
+
+        case NodeKind::Class:
+          if (!item->as<NdClass>()->is_template())
+            check_class_signature(item->as<NdClass>(), ctx);
+          break;
+
+        case NodeKind::Enum:
+          check_enum(item->as<NdEnum>(), ctx);
+          break;
+
+        case NodeKind::Namespace:
+          check_namespace(item->as<NdNamespace>(), ctx);
+          break;
+      }
+    }
+  }
+
+  // bodies in the namespace. (called in the task of the namespace item)
+  void TypeChecker::check_namespace_body(NdNamespace* node, NdVisitorContext ctx) {
+    ctx.cur_scope = node->scope_ptr->as<SCNamespace>();
+
+    for (auto& item : node->items) {
+      switch (item->kind) {
+        case NodeKind::Function:
+          if (!item->as<NdFunction>()->is_template())
+            check_function_body(item->as<NdFunction>(), ctx);
+          break;
+
+        case NodeKind::Class:
+          if (!item->as<NdClass>()->is_template())
+            check_class_body(item->as<NdClass>(), ctx);
+          break;
+
+        case NodeKind::Namespace:
+          check_namespace_body(item->as<NdNamespace>(), ctx);
+          break;
       }
     }
   }
@@ -708,18 +1183,30 @@ namespace fire {
   void TypeChecker::check_module(NdModule* node, NdVisitorContext ctx) {
     ctx.cur_scope = node->scope_ptr->as<SCModule>();
 
+    std::vector<Node*> items;
+
+    //
+    // 1. signatures, layouts of classes and variables. (serial)
     for (auto& item : node->items) {
+      if (S.is_analyzed(item))
+        continue;
+
+      ctx.cur_item = item;
+
       switch (item->kind) {
         case NodeKind::Let:
           check_stmt(item, ctx);
           break;
 
+        // templates are checked when instantiated.
         case NodeKind::Function:
-          check_function(item->as<NdFunction>(), ctx);
+          if (!item->as<NdFunction>()->is_template())
+            check_function_signature(item->as<NdFunction>(), ctx);
           break;
 
         case NodeKind::Class:
-          check_class(item->as<NdClass>(), ctx);
+          if (!item->as<NdClass>()->is_template())
+            check_class_signature(item->as<NdClass>(), ctx);
           break;
 
         case NodeKind::Enum:
@@ -730,7 +1217,37 @@ namespace fire {
           check_namespace(item->as<NdNamespace>(), ctx);
           break;
       }
+
+      items.push_back(item);
     }
+
+    //
+    // 2. bodies of functions. (parallel)
+    //    a body only writes to its own nodes.
+    S.run_parallel(items.size(), [&](size_t i) {
+      auto item = items[i];
+      auto c = ctx;
+
+      c.cur_item = item;
+
+      switch (item->kind) {
+        case NodeKind::Function:
+          if (!item->as<NdFunction>()->is_template())
+            check_function_body(item->as<NdFunction>(), c);
+          break;
+
+        case NodeKind::Class:
+          if (!item->as<NdClass>()->is_template())
+            check_class_body(item->as<NdClass>(), c);
+          break;
+
+        case NodeKind::Namespace:
+          check_namespace_body(item->as<NdNamespace>(), c);
+          break;
+      }
+
+      S.mark_analyzed(item);
+    });
   }
 
 } // namespace fire
@@ -1,16 +1,28 @@
 #include <fstream>
 #include <filesystem>
-#include <unordered_map>
+#include <algorithm>
 
 #include "Utils.hpp"
 #include "Token.hpp"
 #include "Lexer.hpp"
 #include "Parser.hpp"
+#include "TimeReport.hpp"
+#include "Trace.hpp"
 
 #include "SourceFile.hpp"
 
 namespace fire {
-  std::unordered_map<std::string, SourceFile*> all_sources;
+  static SourceFile::Registry main_sources;
+
+  static SourceFile::Registry* all_sources = &main_sources;
+
+  void SourceFile::set_registry(Registry* reg) {
+    all_sources = reg ? reg : &main_sources;
+  }
+
+  SourceFile::Registry& SourceFile::get_registry() {
+    return *all_sources;
+  }
 
   SourceFile::SourceFile(std::string const& _path) : path(std::filesystem::absolute(_path)) {
     auto ifs = std::ifstream(this->path);
@@ -25,23 +37,47 @@ namespace fire {
 
     length = data.length();
 
-    all_sources[this->path] = this;
+    (*all_sources)[this->path] = this;
+  }
+
+  SourceFile::SourceFile(std::string const& _path, std::string _data)
+      : path(std::filesystem::absolute(_path)), data(std::move(_data)) {
+    if (data.empty() || data.back() != '\n')
+      data += '\n';
+
+    length = data.length();
+
+    (*all_sources)[this->path] = this;
   }
 
   Token* SourceFile::lex() {
     if(lexed_token)return lexed_token;
+    TimeReport::Phase _phase("lex", path);
+    Tracer::Span _span("frontend", "lex", path);
     return lexed_token = Lexer(this).lex();
   }
 
-  NdModule* SourceFile::parse() {
+  NdModule* SourceFile::parse(ConstantPool* pool) {
     if(parsed_mod)return parsed_mod;
-    return parsed_mod = Parser(*this, this->lex()).parse();
+    auto tok = this->lex();
+    TimeReport::Phase _phase("parse", path);
+    Tracer::Span _span("frontend", "parse", path);
+    return parsed_mod = Parser(*this, tok, pool).parse();
   }
 
   //
   // import a file
   SourceFile* SourceFile::import(std::string const& _path) {
-    if (all_sources.find(_path) != all_sources.end()) { return all_sources[_path]; }
+    if (auto it = all_sources->find(_path); it != all_sources->end()) {
+      auto src = it->second;
+
+      // imported by another file already. (items are merged only once,
+      // see is_node_imported)
+      if (src != this && std::find(imports.begin(), imports.end(), src) == imports.end())
+        this->imports.push_back(src);
+
+      return src;
+    }
 
     auto new_source = new SourceFile(_path);
 
@@ -55,6 +91,8 @@ namespace fire {
   //
   // import a directory
   void SourceFile::import_directory(std::string const& _path) {
+    this->import_dirs.push_back(_path);
+
     //
     // get all files in the directory
     for (auto& entry : std::filesystem::directory_iterator(_path)) {
@@ -66,6 +104,29 @@ namespace fire {
     }
   }
 
+  SourceFile* SourceFile::reload() const {
+    auto src = read(this->path);
+
+    if (src)
+      src->parent = this->parent;
+
+    return src;
+  }
+
+  SourceFile* SourceFile::read(std::string const& _path) {
+    auto ifs = std::ifstream(_path);
+
+    if (ifs.fail())
+      return nullptr;
+
+    std::string data;
+
+    for (std::string line; std::getline(ifs, line);)
+      data.append(line.append("\n"));
+
+    return new SourceFile(_path, std::move(data));
+  }
+
   std::string SourceFile::get_folder() const {
     return path.substr(0, path.find_last_of('/') + 1);
   }
@@ -0,0 +1,37 @@
+#include <cstring>
+
+#include "StringArena.hpp"
+
+namespace fire {
+
+  std::string_view StringArena::store(std::string_view str) {
+    size_t len = str.length();
+
+    if (len == 0)
+      return {};
+
+    used += len;
+
+    // big string has its own block.
+    if (len > BlockSize / 4) {
+      auto& block = blocks.emplace_back(new char[len]);
+      std::memcpy(block.get(), str.data(), len);
+      return {block.get(), len};
+    }
+
+    if (len > left) {
+      cur = blocks.emplace_back(new char[BlockSize]).get();
+      left = BlockSize;
+    }
+
+    auto p = cur;
+
+    std::memcpy(p, str.data(), len);
+
+    cur += len;
+    left -= len;
+
+    return {p, len};
+  }
+
+} // namespace fire
@@ -0,0 +1,38 @@
+#include <stdexcept>
+
+#include "Utils.hpp"
+#include "StringBuilder.hpp"
+
+namespace fire {
+
+  void StringBuilder::append(Object const* obj) {
+    switch (obj->type.kind) {
+      case TypeKind::String:
+        append(obj->as<ObjString>());
+        break;
+
+      case TypeKind::Char:
+        append(obj->as<ObjChar>()->val);
+        break;
+
+      // Sema allows only string or char.
+      default:
+        throw std::logic_error("StringBuilder::append: not a string or char: " +
+                               obj->type.to_string());
+    }
+  }
+
+  ObjString* StringBuilder::snapshot() const {
+    return new ObjString(buf);
+  }
+
+  ObjString* StringBuilder::finish() {
+    auto str = new ObjString();
+
+    str->data = std::move(buf);
+    buf.clear();
+
+    return str;
+  }
+
+} // namespace fire
@@ -0,0 +1,143 @@
+#include "ThreadPool.hpp"
+
+namespace fire {
+
+  // queue of current thread, while it's running tasks of cur_pool.
+  static thread_local ThreadPool const* cur_pool = nullptr;
+  static thread_local size_t cur_index = 0;
+
+  ThreadPool::ThreadPool(size_t count) {
+    if (count == 0)
+      count = 1;
+
+    for (size_t i = 0; i <= count; i++)
+      queues.emplace_back(new Queue());
+
+    for (size_t i = 0; i < count; i++)
+      threads.emplace_back(&ThreadPool::worker_main, this, i);
+  }
+
+  ThreadPool::~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      stop = true;
+    }
+
+    cv_task.notify_all();
+
+    for (auto& t : threads)
+      t.join();
+  }
+
+  size_t ThreadPool::default_size() {
+    auto n = std::thread::hardware_concurrency();
+    return n ? n : 1;
+  }
+
+  void ThreadPool::submit(Task task) {
+    size_t index = cur_pool == this ? cur_index : next_queue++ % threads.size();
+
+    pending++;
+
+    // counted with the queue locked, so pop() can't take it before.
+    // (and under mtx, so sleeping workers see the count)
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      std::lock_guard<std::mutex> queue_lock(queues[index]->mtx);
+
+      queues[index]->tasks.emplace_back(std::move(task));
+      queued++;
+    }
+
+    cv_task.notify_one();
+  }
+
+  bool ThreadPool::pop(size_t index, Task& out) {
+    if (queued == 0)
+      return false;
+
+    // own queue. (LIFO)
+    {
+      auto& Q = *queues[index];
+      std::lock_guard<std::mutex> lock(Q.mtx);
+
+      if (!Q.tasks.empty()) {
+        out = std::move(Q.tasks.back());
+        Q.tasks.pop_back();
+        queued--;
+        return true;
+      }
+    }
+
+    // steal from others. (FIFO)
+    for (size_t i = 1; i < queues.size(); i++) {
+      auto& Q = *queues[(index + i) % queues.size()];
+      std::lock_guard<std::mutex> lock(Q.mtx);
+
+      if (!Q.tasks.empty()) {
+        out = std::move(Q.tasks.front());
+        Q.tasks.pop_front();
+        queued--;
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  void ThreadPool::run(Task& task) {
+    task();
+    task = nullptr;
+
+    if (--pending == 0) {
+      std::lock_guard<std::mutex> lock(mtx);
+      cv_done.notify_all();
+    }
+  }
+
+  void ThreadPool::worker_main(size_t index) {
+    cur_pool = this;
+    cur_index = index;
+
+    Task task;
+
+    while (true) {
+      if (pop(index, task)) {
+        run(task);
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lock(mtx);
+
+      cv_task.wait(lock, [this] { return stop || queued > 0; });
+
+      if (stop)
+        break;
+    }
+  }
+
+  void ThreadPool::wait() {
+    auto const saved_pool = cur_pool;
+    auto const saved_index = cur_index;
+
+    cur_pool = this;
+    cur_index = threads.size();
+
+    Task task;
+
+    while (pending > 0) {
+      if (pop(cur_index, task)) {
+        run(task);
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lock(mtx);
+
+      cv_done.wait(lock, [this] { return pending == 0 || queued > 0; });
+    }
+
+    cur_pool = saved_pool;
+    cur_index = saved_index;
+  }
+
+} // namespace fire
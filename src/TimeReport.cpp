@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+#include <sys/resource.h>
+
+#include "Utils.hpp"
+#include "TimeReport.hpp"
+
+namespace fire {
+
+  using Stats = TimeReport::Stats;
+
+  TimeReport::Stats& TimeReport::Stats::operator+=(Stats const& s) {
+    wall_ms += s.wall_ms;
+    cpu_ms += s.cpu_ms;
+    allocs += s.allocs;
+    alloc_bytes += s.alloc_bytes;
+    peak_rss_kb = std::max(peak_rss_kb, s.peak_rss_kb);
+    return *this;
+  }
+
+  TimeReport::Stats TimeReport::Stats::operator-(Stats const& s) const {
+    return {
+        .wall_ms = wall_ms - s.wall_ms,
+        .cpu_ms = cpu_ms - s.cpu_ms,
+        .allocs = allocs - s.allocs,
+        .alloc_bytes = alloc_bytes - s.alloc_bytes,
+        .peak_rss_kb = peak_rss_kb,
+    };
+  }
+
+  TimeReport::Phase::Phase(char const* phase, std::string const& file) {
+    if ((active = TimeReport::get_instance().enabled))
+      TimeReport::get_instance().begin(phase, file);
+  }
+
+  TimeReport::Phase::~Phase() {
+    if (active)
+      TimeReport::get_instance().end();
+  }
+
+  TimeReport& TimeReport::get_instance() {
+    static TimeReport inst;
+    return inst;
+  }
+
+  TimeReport::Stats TimeReport::now() {
+    using namespace std::chrono;
+
+    Stats s;
+
+    s.wall_ms = duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    s.cpu_ms = ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+
+    s.allocs = AllocCounter::count.load(std::memory_order_relaxed);
+    s.alloc_bytes = AllocCounter::bytes.load(std::memory_order_relaxed);
+
+    rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    s.peak_rss_kb = ru.ru_maxrss; // KiB on Linux
+
+    return s;
+  }
+
+  void TimeReport::enable(std::string const& json_path) {
+    if (!enabled)
+      std::atexit(TimeReport::finish);
+
+    this->enabled = true;
+
+    AllocCounter::enabled.store(true, std::memory_order_relaxed);
+    this->json_path = json_path;
+
+    start = now();
+  }
+
+  void TimeReport::begin(char const* phase, std::string const& file) {
+    frames.push_back({.file = file, .phase = phase, .start = now()});
+  }
+
+  void TimeReport::end() {
+    auto F = std::move(frames.back());
+    frames.pop_back();
+
+    auto total = now() - F.start;
+
+    if (!frames.empty())
+      frames.back().nested += total;
+
+    auto self = total - F.nested;
+    self.peak_rss_kb = total.peak_rss_kb;
+
+    entries.push_back({.file = std::move(F.file), .phase = std::move(F.phase), .stats = self});
+  }
+
+  // the compiler may stop by exit(), so report is done in atexit.
+  void TimeReport::finish() {
+    auto& R = get_instance();
+
+    while (!R.frames.empty())
+      R.end();
+
+    if (R.json_path.empty())
+      R.print();
+    else
+      R.write_json(R.json_path);
+  }
+
+  // totals of each phase, in order of first appearance.
+  static std::vector<std::pair<std::string, Stats>> sum_phases(
+      std::vector<TimeReport::Entry> const& entries) {
+    std::vector<std::pair<std::string, Stats>> ret;
+
+    for (auto const& e : entries) {
+      auto it = std::find_if(ret.begin(), ret.end(), [&e](auto& p) { return p.first == e.phase; });
+
+      if (it == ret.end())
+        ret.emplace_back(e.phase, e.stats);
+      else
+        it->second += e.stats;
+    }
+
+    return ret;
+  }
+
+  void TimeReport::print() const {
+    auto row = [](std::string const& file, std::string const& phase, Stats const& s) {
+      std::fprintf(stderr, "%-32s %-8s %10.3f %10.3f %10zu %12.1f %10zu\n", file.c_str(),
+                   phase.c_str(), s.wall_ms, s.cpu_ms, s.allocs, s.alloc_bytes / 1024.0,
+                   s.peak_rss_kb);
+    };
+
+    std::fprintf(stderr, "\n===-- time report --===\n");
+    std::fprintf(stderr, "%-32s %-8s %10s %10s %10s %12s %10s\n", "file", "phase", "wall(ms)",
+                 "cpu(ms)", "allocs", "alloc(KiB)", "rss(KiB)");
+
+    for (auto const& e : entries) {
+      auto name = e.file;
+
+      if (name.length() > 32)
+        name = "..." + name.substr(name.length() - 29);
+
+      row(name, e.phase, e.stats);
+    }
+
+    for (auto const& [phase, s] : sum_phases(entries))
+      row("total", phase, s);
+
+    row("total", "all", now() - start);
+  }
+
+  static std::string json_stats(Stats const& s) {
+    return format("{\"wall_ms\": %.3f, \"cpu_ms\": %.3f, \"allocs\": %zu, \"alloc_bytes\": %zu, "
+                  "\"peak_rss_kb\": %zu}",
+                  s.wall_ms, s.cpu_ms, s.allocs, s.alloc_bytes, s.peak_rss_kb);
+  }
+
+  void TimeReport::write_json(std::string const& path) const {
+    auto fp = std::fopen(path.c_str(), "w");
+
+    if (!fp) {
+      std::fprintf(stderr, "cannot open file: %s\n", path.c_str());
+      return;
+    }
+
+    std::fprintf(fp, "{\n  \"entries\": [");
+
+    for (size_t i = 0; i < entries.size(); i++) {
+      auto const& e = entries[i];
+
+      std::fprintf(fp, "%s\n    {\"file\": %s, \"phase\": %s, \"stats\": %s}", i ? "," : "",
+                   json_string(e.file).c_str(), json_string(e.phase).c_str(),
+                   json_stats(e.stats).c_str());
+    }
+
+    std::fprintf(fp, "\n  ],\n  \"phases\": {");
+
+    bool first = true;
+
+    for (auto const& [phase, s] : sum_phases(entries)) {
+      std::fprintf(fp, "%s\n    %s: %s", first ? "" : ",", json_string(phase).c_str(),
+                   json_stats(s).c_str());
+      first = false;
+    }
+
+    std::fprintf(fp, "\n  },\n  \"total\": %s\n}\n", json_stats(now() - start).c_str());
+
+    std::fclose(fp);
+  }
+
+} // namespace fire
@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "Utils.hpp"
+#include "Trace.hpp"
+
+namespace fire {
+
+  // small id of thread for "tid". (main thread = 1)
+  static int get_tid() {
+    static std::atomic<int> count = 0;
+    static thread_local int tid = ++count;
+    return tid;
+  }
+
+  Tracer::Span::Span(char const* category, std::string_view name, std::string_view file) {
+    if (auto& T = Tracer::get_instance(); T.enabled)
+      index = T.begin(category, name, file);
+  }
+
+  Tracer::Span::~Span() {
+    if (index >= 0)
+      Tracer::get_instance().end(index);
+  }
+
+  Tracer& Tracer::get_instance() {
+    static Tracer inst;
+    return inst;
+  }
+
+  double Tracer::now_us() {
+    using namespace std::chrono;
+    return duration<double, std::micro>(steady_clock::now().time_since_epoch()).count();
+  }
+
+  void Tracer::enable(std::string const& path) {
+    if (!enabled)
+      std::atexit(Tracer::finish);
+
+    get_tid();
+
+    this->enabled = true;
+    this->path = path;
+  }
+
+  long Tracer::begin(char const* category, std::string_view name, std::string_view file) {
+    Event e{
+        .name = std::string(name),
+        .category = category,
+        .file = std::string(file),
+        .ts_us = now_us(),
+        .tid = get_tid(),
+    };
+
+    std::lock_guard<std::mutex> lock(mtx);
+
+    events.emplace_back(std::move(e));
+
+    return (long)events.size() - 1;
+  }
+
+  void Tracer::end(long index) {
+    auto t = now_us();
+
+    std::lock_guard<std::mutex> lock(mtx);
+
+    events[index].dur_us = t - events[index].ts_us;
+  }
+
+  void Tracer::finish() {
+    auto& T = get_instance();
+
+    T.write(T.path);
+  }
+
+  void Tracer::write(std::string const& path) {
+    auto fp = std::fopen(path.c_str(), "w");
+
+    if (!fp) {
+      std::fprintf(stderr, "cannot open file: %s\n", path.c_str());
+      return;
+    }
+
+    auto t = now_us();
+
+    std::lock_guard<std::mutex> lock(mtx);
+
+    double base = events.empty() ? t : events[0].ts_us;
+
+    int max_tid = 1;
+
+    std::fprintf(fp, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+
+    for (auto& e : events) {
+      // spans not ended by exit().
+      if (e.dur_us < 0)
+        e.dur_us = t - e.ts_us;
+
+      std::fprintf(fp,
+                   "  {\"name\": %s, \"cat\": \"%s\", \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, "
+                   "\"pid\": 1, \"tid\": %d",
+                   json_string(e.name).c_str(), e.category, e.ts_us - base, e.dur_us, e.tid);
+
+      if (!e.file.empty())
+        std::fprintf(fp, ", \"args\": {\"file\": %s}", json_string(e.file).c_str());
+
+      std::fprintf(fp, "},\n");
+
+      max_tid = std::max(max_tid, e.tid);
+    }
+
+    for (int i = 1; i <= max_tid; i++) {
+      std::fprintf(fp,
+                   "  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, "
+                   "\"args\": {\"name\": \"%s %d\"}}%s\n",
+                   i, i == 1 ? "main" : "worker", i, i == max_tid ? "" : ",");
+    }
+
+    std::fprintf(fp, "]}\n");
+
+    std::fclose(fp);
+  }
+
+} // namespace fire
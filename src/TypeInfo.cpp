@@ -1,9 +1,26 @@
+#include <mutex>
+#include <unordered_set>
+
 #include "Utils.hpp"
 #include "Node.hpp"
 #include "TypeInfo.hpp"
 
 namespace fire {
 
+  namespace {
+    struct TypeInfoHash {
+      size_t operator()(TypeInfo const& t) const {
+        return t.hash();
+      }
+    };
+
+    struct TypeInfoEqual {
+      bool operator()(TypeInfo const& a, TypeInfo const& b) const {
+        return a.equals(b) && a.is_var_arg_functor == b.is_var_arg_functor;
+      }
+    };
+  } // namespace
+
   bool TypeInfo::equals(TypeInfo const& t, bool cr, bool cc) const {
 
     if (kind != t.kind)
@@ -23,9 +40,36 @@ namespace fire {
     if (cc && is_const != t.is_const)
       return false;
 
+    if (class_node != t.class_node || enum_node != t.enum_node)
+      return false;
+
     return true;
   }
 
+  size_t TypeInfo::hash() const {
+    size_t h = static_cast<size_t>(kind);
+
+    auto mix = [&h](size_t v) { h ^= v + 0x9e3779b97f4a7c15 + (h << 6) + (h >> 2); };
+
+    for (auto const& p : parameters)
+      mix(p.hash());
+
+    mix(std::hash<void const*>()(class_node));
+    mix(std::hash<void const*>()(enum_node));
+    mix((is_ref << 2) | (is_const << 1) | is_var_arg_functor);
+
+    return h;
+  }
+
+  TypeInfo const* TypeInfo::intern(TypeInfo const& t) {
+    static std::unordered_set<TypeInfo, TypeInfoHash, TypeInfoEqual> table;
+    static std::mutex mtx;
+
+    std::lock_guard<std::mutex> lock(mtx);
+
+    return &*table.insert(t).first;
+  }
+
   std::string TypeInfo::to_string() const {
     static char const* names[]{
         "none",   "int", "float", "usize", "bool", "char",
@@ -37,6 +81,12 @@ namespace fire {
     switch (kind) {
       case TypeKind::Class:
         str = this->class_node->name.text;
+
+        if (!class_node->template_args.empty())
+          str += "<" + join(", ", class_node->template_args, [](TypeInfo const& t) {
+                   return t.to_string();
+                 }) + ">";
+
         break;
 
       case TypeKind::Enum:
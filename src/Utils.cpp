@@ -19,8 +19,37 @@ namespace fire {
     return ss.str();
   }
 
+  static bool todo_throws = false;
+
+  void todo_reached(char const* file, int line) {
+    if (todo_throws)
+      throw todo_error{file, line};
+
+    fprintf(stderr, "\t#todoimpl at %s:%d\n", file, line);
+    exit(22);
+  }
+
+  void set_todo_throws(bool enable) {
+    todo_throws = enable;
+  }
+
+  std::string json_string(std::string_view s) {
+    std::string ret = "\"";
+
+    for (char c : s) {
+      if (c == '"' || c == '\\')
+        ret += '\\', ret += c;
+      else if ((unsigned char)c < 0x20)
+        ret += format("\\u%04x", c);
+      else
+        ret += c;
+    }
+
+    return ret + "\"";
+  }
+
   std::string node2s(Node* node) {
-    static int indent = 0;
+    static thread_local int indent = 0;
 
     if (!node) return "";
 
@@ -32,15 +61,8 @@ namespace fire {
         return "self";
 
       case NodeKind::Value: {
-        std::stringstream ss;
-        if (node->token.kind == TokenKind::Char) {
-          ss << "'" << node->token.text << "'";
-        } else if (node->token.kind == TokenKind::String) {
-          ss << "\"" << node->token.text << "\"";
-        } else {
-          ss << node->token.text;
-        }
-        return ss.str();
+        // text of literal has quotes and escapes as written.
+        return std::string(node->token.text);
       }
 
       case NodeKind::Symbol: {
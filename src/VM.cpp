@@ -0,0 +1,187 @@
+#include <algorithm>
+
+#include "Utils.hpp"
+#include "Node.hpp"
+#include "VM.hpp"
+
+namespace fire::VM {
+
+  bool ExceptionTable::can_catch(TypeInfo const& catch_type, TypeInfo const& thrown) {
+    if (catch_type.is(TypeKind::Any))
+      return true;
+
+    if (catch_type.equals(thrown, false, false))
+      return true;
+
+    // base class catches derived one
+    if (catch_type.is(TypeKind::Class) && thrown.is(TypeKind::Class)) {
+      for (auto C = thrown.class_node; C && C->base_class; C = C->base_class->ty.class_node) {
+        if (C->base_class->ty.class_node == catch_type.class_node)
+          return true;
+      }
+    }
+
+    return false;
+  }
+
+  ExceptionHandler const* ExceptionTable::find(size_t pc, TypeInfo const& thrown) const {
+    for (auto const& h : handlers) {
+      if (h.covers(pc) && (h.is_finally || can_catch(h.catch_type, thrown)))
+        return &h;
+    }
+
+    return nullptr;
+  }
+
+  void ExceptionTableBuilder::begin_try(size_t pc) {
+    regions.push_back({.begin_pc = pc, .end_pc = pc});
+  }
+
+  void ExceptionTableBuilder::end_try_body(size_t pc) {
+    regions.back().end_pc = pc;
+  }
+
+  void ExceptionTableBuilder::add_catch(TypeInfo const& type, size_t handler_pc) {
+    auto& R = regions.back();
+
+    R.handlers.push_back({
+        .begin_pc = R.begin_pc,
+        .end_pc = R.end_pc,
+        .handler_pc = handler_pc,
+        .catch_type = type,
+    });
+  }
+
+  void ExceptionTableBuilder::add_finally(size_t catch_end_pc, size_t handler_pc) {
+    auto& R = regions.back();
+
+    R.handlers.push_back({
+        .begin_pc = R.begin_pc,
+        .end_pc = catch_end_pc,
+        .handler_pc = handler_pc,
+        .is_finally = true,
+    });
+  }
+
+  void ExceptionTableBuilder::end_try() {
+    for (auto& h : regions.back().handlers)
+      table.handlers.emplace_back(std::move(h));
+
+    regions.pop_back();
+  }
+
+  ClassLayout::Field const* ClassLayout::find_field(std::string_view name) const {
+    for (auto const& f : fields) {
+      if (f.name == name)
+        return &f;
+    }
+
+    return nullptr;
+  }
+
+  ClassLayout* ClassLayout::of(NdClass* node) {
+    if (node->layout)
+      return node->layout;
+
+    auto L = new ClassLayout();
+
+    L->node = node;
+
+    if (node->base_class) {
+      assert(node->base_class->ty.is(TypeKind::Class));
+
+      L->base = ClassLayout::of(node->base_class->ty.class_node);
+      L->fields = L->base->fields;
+      L->vtable = L->base->vtable;
+    }
+
+    for (auto field : node->fields) {
+      field->index = (int)L->fields.size();
+
+      L->fields.push_back({
+          .node = field,
+          .name = field->name.text,
+          .offset = L->fields.size(),
+      });
+    }
+
+    for (auto method : node->methods) {
+      method->vtable_index = -1;
+
+      // override: use same slot as base's one
+      for (size_t i = 0; i < L->vtable.size(); i++) {
+        if (L->vtable[i]->name.text == method->name.text) {
+          method->vtable_index = (int)i;
+          L->vtable[i] = method;
+          break;
+        }
+      }
+
+      if (method->vtable_index == -1) {
+        method->vtable_index = (int)L->vtable.size();
+        L->vtable.push_back(method);
+      }
+    }
+
+    return node->layout = L;
+  }
+
+  NdFunction* InlineCache::miss(ClassLayout const* klass) {
+    misses++;
+
+    auto method = klass->vtable[call_site->func_nd->vtable_index];
+
+    if (state == Megamorphic)
+      return method;
+
+    if (count == MaxEntries) {
+      // too many receiver classes; stop caching at this site.
+      state = Megamorphic;
+      count = 0;
+      return method;
+    }
+
+    entries[count++] = {.klass = klass, .method = method};
+    state = count == 1 ? Monomorphic : Polymorphic;
+
+    return method;
+  }
+
+  Token const* Function::token_of(size_t pc) const {
+    auto it = std::upper_bound(lines.begin(), lines.end(), pc,
+                               [](size_t pc, LineEntry const& e) { return pc < e.pc; });
+
+    return it == lines.begin() ? nullptr : (it - 1)->token;
+  }
+
+  bool Context::raise(Object* exception) {
+    if (!exception)
+      return false;
+
+    for (Frame* f = frame; f; f = f->prev) {
+      if (!f->func || f->func->exceptions.empty())
+        continue;
+
+      if (auto h = f->func->exceptions.find(f->pc, exception->type); h) {
+        frame = f;
+        frame->pc = h->handler_pc;
+
+        if (h->is_finally)
+          pending_exception = exception;
+        else
+          caught_exception = exception;
+
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  bool Context::rethrow(Object* exception) {
+    // the finally handler itself is outside of its own region,
+    // so searching from the current pc finds the outer handler.
+    return raise(exception);
+  }
+
+} // namespace fire::VM
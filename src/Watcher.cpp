@@ -0,0 +1,154 @@
+#include <chrono>
+#include <cstdio>
+#include <cerrno>
+#include <cstring>
+
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include "Utils.hpp"
+#include "FileSystem.hpp"
+#include "Watcher.hpp"
+
+namespace fire {
+
+  // events in this time after a change are handled together.
+  // (editors write a file in some steps)
+  static constexpr int DebounceMs = 50;
+
+  static constexpr uint32_t WatchMask =
+      IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE;
+
+  Watcher::Watcher(std::string const& path) : program(path) {
+  }
+
+  Watcher::~Watcher() {
+    if (fd >= 0)
+      close(fd);
+  }
+
+  int Watcher::run() {
+    fd = inotify_init1(IN_CLOEXEC);
+
+    if (fd < 0) {
+      std::perror("inotify_init1");
+      return 1;
+    }
+
+    // "todo" in the compiler must not end watching.
+    set_todo_throws(true);
+
+    build();
+
+    while (true) {
+      if (!watch_folders())
+        return 1;
+
+      std::fprintf(stderr, "watching %zu files... (Ctrl+C to stop)\n",
+                   program.get_registry().size());
+
+      bool changed = false;
+
+      for (auto& path : wait_changes())
+        changed |= program.update_path(path);
+
+      if (changed)
+        build();
+    }
+  }
+
+  void Watcher::build() {
+    auto begin = std::chrono::steady_clock::now();
+
+    int code = program.build();
+
+    std::fflush(stdout);
+
+    // reached to lowering.
+    if (code == 0 || code == 22) {
+      std::fprintf(stderr, "checked %zu items, parsed %zu files in %.1f ms\n",
+                   program.get_checked_count(), program.get_parsed_count(),
+                   std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() -
+                                                             begin)
+                       .count());
+    }
+  }
+
+  bool Watcher::watch_folders() {
+    std::vector<std::string> list;
+
+    for (auto& [path, src] : program.get_registry()) {
+      list.emplace_back(FileSystem::GetFolderOfFile(path));
+
+      for (auto& dir : src->import_dirs)
+        list.emplace_back(FileSystem::StripTrailingSlash(dir));
+    }
+
+    for (auto& folder : list) {
+      if (watched.count(folder))
+        continue;
+
+      int wd = inotify_add_watch(fd, folder.c_str(), WatchMask);
+
+      if (wd < 0) {
+        std::fprintf(stderr, "cannot watch '%s': %s\n", folder.c_str(), std::strerror(errno));
+        continue;
+      }
+
+      folders[wd] = folder;
+      watched.insert(folder);
+    }
+
+    if (folders.empty()) {
+      std::fprintf(stderr, "no folders to watch.\n");
+      return false;
+    }
+
+    return true;
+  }
+
+  std::unordered_set<std::string> Watcher::wait_changes() {
+    std::unordered_set<std::string> paths;
+
+    alignas(inotify_event) char buf[4096];
+    int timeout = -1;
+
+    while (true) {
+      pollfd p = {.fd = fd, .events = POLLIN, .revents = 0};
+
+      if (int n = poll(&p, 1, timeout); n <= 0) {
+        if (n < 0 && errno == EINTR)
+          continue;
+
+        break;
+      }
+
+      ssize_t len = read(fd, buf, sizeof(buf));
+
+      if (len <= 0)
+        break;
+
+      for (char* ptr = buf; ptr < buf + len;) {
+        auto ev = reinterpret_cast<inotify_event*>(ptr);
+
+        if (auto it = folders.find(ev->wd); it != folders.end()) {
+          if (ev->mask & IN_IGNORED) {
+            // the folder is removed.
+            watched.erase(it->second);
+            folders.erase(it);
+          } else if (ev->len > 0) {
+            paths.insert(it->second + "/" + ev->name);
+          }
+        }
+
+        ptr += sizeof(inotify_event) + ev->len;
+      }
+
+      timeout = DebounceMs;
+    }
+
+    return paths;
+  }
+
+} // namespace fire
@@ -1,51 +1,28 @@
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 #include "strconv.hpp"
 
+#if defined(__x86_64__) || defined(__i386__)
+#define STRCONV_X86 1
+#include <immintrin.h>
+#endif
+
 /* replacement character */
 #define U_REPLACEMENT 0xFFFD
 
-/* ---------------- UTF-8 decoding ---------------- */
-
-static uint32_t utf8_decode(const unsigned char** p)
-{
-    const unsigned char* s = *p;
-    uint32_t cp;
-
-    if (s[0] < 0x80) {
-        cp = s[0];
-        *p += 1;
-        return cp;
-    }
-    if ((s[0] & 0xE0) == 0xC0 && (s[1] & 0xC0) == 0x80) {
-        cp = ((s[0] & 0x1F) << 6) | (s[1] & 0x3F);
-        *p += 2;
-        return (cp >= 0x80) ? cp : U_REPLACEMENT;
-    }
-    if ((s[0] & 0xF0) == 0xE0 &&
-        (s[1] & 0xC0) == 0x80 &&
-        (s[2] & 0xC0) == 0x80) {
-        cp = ((s[0] & 0x0F) << 12) |
-             ((s[1] & 0x3F) << 6) |
-             (s[2] & 0x3F);
-        *p += 3;
-        return (cp >= 0x800) ? cp : U_REPLACEMENT;
-    }
-    if ((s[0] & 0xF8) == 0xF0 &&
-        (s[1] & 0xC0) == 0x80 &&
-        (s[2] & 0xC0) == 0x80 &&
-        (s[3] & 0xC0) == 0x80) {
-        cp = ((s[0] & 0x07) << 18) |
-             ((s[1] & 0x3F) << 12) |
-             ((s[2] & 0x3F) << 6) |
-             (s[3] & 0x3F);
-        *p += 4;
-        return (cp >= 0x10000 && cp <= 0x10FFFF) ? cp : U_REPLACEMENT;
-    }
+/*
+ * every transcoder is a kernel of (out, input, len) -> units.
+ * if out is null, it counts units of the output only.
+ *
+ * runs of ascii are converted by blocks (8 bytes in scalar, 16 in sse4,
+ * 32 in avx2), and other characters are decoded one by one with
+ * validation. vector kernels also convert utf-16 below U+0800 by blocks,
+ * and use the scalar loop for other non-ascii text.
+ * invalid sequences become U+FFFD in all kernels.
+ */
 
-    (*p)++;
-    return U_REPLACEMENT;
-}
+/* ---------------- UTF-8 decoding ---------------- */
 
 static uint32_t utf8_decode_len(
     const unsigned char** p,
@@ -96,155 +73,533 @@ static uint32_t utf8_decode_len(
     return U_REPLACEMENT;
 }
 
-/* ---------------- UTF-16 encoding ---------------- */
+/* ---------------- UTF-16 decoding ---------------- */
 
-static size_t utf16_len_from_utf8(const char* s)
-{
-    size_t len = 0;
-    const unsigned char* p = (const unsigned char*)s;
+static uint32_t utf16_decode_len(
+    const char16_t** p,
+    const char16_t* end
+) {
+    uint32_t w1 = (*p)[0];
 
-    while (*p) {
-        uint32_t cp = utf8_decode(&p);
-        len += (cp >= 0x10000) ? 2 : 1;
+    if (w1 >= 0xD800 && w1 <= 0xDBFF) {
+        uint32_t w2 = (*p + 1 < end) ? (*p)[1] : 0;
+        if (w2 >= 0xDC00 && w2 <= 0xDFFF) {
+            *p += 2;
+            return ((w1 - 0xD800) << 10) + (w2 - 0xDC00) + 0x10000;
+        }
+        (*p)++;
+        return U_REPLACEMENT;
     }
-    return len;
+    (*p)++;
+    return w1;
 }
 
-char16_t* utf8_to_utf16(char16_t* out, char const* input)
-{
-    if (!input) return NULL;
+/* ---------------- one character ---------------- */
 
-    size_t len = utf16_len_from_utf8(input);
-    if (!out) {
-        out = (char16_t*)malloc((len + 1) * sizeof(char16_t));
-        if (!out) return NULL;
+/* converts one character at p (not ascii in most cases). */
+template <bool Write>
+static inline size_t utf8_to_utf16_char(
+    char16_t* dst,
+    const unsigned char** p,
+    const unsigned char* end
+) {
+    uint32_t cp = utf8_decode_len(p, end);
+
+    if (cp <= 0xFFFF) {
+        if (Write) dst[0] = (char16_t)cp;
+        return 1;
     }
 
-    const unsigned char* p = (const unsigned char*)input;
-    char16_t* dst = out;
-
-    while (*p) {
-        uint32_t cp = utf8_decode(&p);
-        if (cp <= 0xFFFF) {
-            *dst++ = (char16_t)cp;
-        } else {
-            cp -= 0x10000;
-            *dst++ = (char16_t)(0xD800 | (cp >> 10));
-            *dst++ = (char16_t)(0xDC00 | (cp & 0x3FF));
+    if (Write) {
+        cp -= 0x10000;
+        dst[0] = (char16_t)(0xD800 | (cp >> 10));
+        dst[1] = (char16_t)(0xDC00 | (cp & 0x3FF));
+    }
+    return 2;
+}
+
+template <bool Write>
+static inline size_t utf16_to_utf8_char(
+    char* dst,
+    const char16_t** p,
+    const char16_t* end
+) {
+    uint32_t cp = utf16_decode_len(p, end);
+
+    if (cp < 0x80) {
+        if (Write) dst[0] = (char)cp;
+        return 1;
+    }
+    if (cp < 0x800) {
+        if (Write) {
+            dst[0] = (char)(0xC0 | (cp >> 6));
+            dst[1] = (char)(0x80 | (cp & 0x3F));
         }
+        return 2;
     }
-    *dst = 0;
-    return out;
+    if (cp < 0x10000) {
+        if (Write) {
+            dst[0] = (char)(0xE0 | (cp >> 12));
+            dst[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+            dst[2] = (char)(0x80 | (cp & 0x3F));
+        }
+        return 3;
+    }
+    if (Write) {
+        dst[0] = (char)(0xF0 | (cp >> 18));
+        dst[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+        dst[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        dst[3] = (char)(0x80 | (cp & 0x3F));
+    }
+    return 4;
 }
 
-/* ---------------- UTF-16 decoding ---------------- */
+/* ---------------- scalar ---------------- */
 
-static uint32_t utf16_decode(const char16_t** p)
-{
-    uint32_t w1 = (*p)[0];
+/*
+ * vector kernels go to the scalar loop at a block they can't convert, and
+ * it returns to them after STRCONV_RESUME_ASCII units of ascii in a row.
+ * (in non-ascii text the vector loop would fail on every block, and copy
+ * the ascii before the first failing unit one by one)
+ */
+#define STRCONV_RESUME_ASCII 8
 
-    if (w1 >= 0xD800 && w1 <= 0xDBFF) {
-        uint32_t w2 = (*p)[1];
-        if (w2 >= 0xDC00 && w2 <= 0xDFFF) {
-            *p += 2;
-            return ((w1 - 0xD800) << 10) + (w2 - 0xDC00) + 0x10000;
+template <bool Write, bool Resume>
+__attribute__((always_inline))
+static inline size_t utf8_to_utf16_run(
+    char16_t* out,
+    const unsigned char** pp,
+    const unsigned char* end
+) {
+    const unsigned char* p = *pp;
+    size_t n = 0;
+
+    while (p < end) {
+        const unsigned char* ascii = p;
+
+        /* 8 ascii bytes */
+        uint64_t w;
+        while (end - p >= 8 &&
+               __builtin_expect((memcpy(&w, p, 8), (w & 0x8080808080808080ull) == 0), 1)) {
+            if (Write)
+                for (int i = 0; i < 8; i++)
+                    out[n + i] = p[i];
+            p += 8;
+            n += 8;
+
+            if (Resume && p - ascii >= STRCONV_RESUME_ASCII) {
+                *pp = p;
+                return n;
+            }
         }
-        (*p)++;
-        return U_REPLACEMENT;
+
+        /* ascii before the first non-ascii byte */
+        while (p < end && *p < 0x80) {
+            if (Write) out[n] = *p;
+            p++;
+            n++;
+        }
+
+        if (p == end) break;
+
+        /* run of non-ascii characters */
+        do {
+            n += utf8_to_utf16_char<Write>(Write ? out + n : NULL, &p, end);
+        } while (p < end && *p >= 0x80);
     }
-    (*p)++;
-    return w1;
+
+    *pp = p;
+    return n;
+}
+
+template <bool Write, bool Resume>
+__attribute__((always_inline))
+static inline size_t utf16_to_utf8_run(
+    char* out,
+    const char16_t** pp,
+    const char16_t* end
+) {
+    const char16_t* p = *pp;
+    size_t n = 0;
+
+    while (p < end) {
+        const char16_t* ascii = p;
+
+        /* 4 ascii units */
+        uint64_t w;
+        while (end - p >= 4 &&
+               __builtin_expect((memcpy(&w, p, 8), (w & 0xFF80FF80FF80FF80ull) == 0), 1)) {
+            if (Write)
+                for (int i = 0; i < 4; i++)
+                    out[n + i] = (char)p[i];
+            p += 4;
+            n += 4;
+
+            if (Resume && p - ascii >= STRCONV_RESUME_ASCII) {
+                *pp = p;
+                return n;
+            }
+        }
+
+        /* ascii before the first non-ascii unit */
+        while (p < end && *p < 0x80) {
+            if (Write) out[n] = (char)*p;
+            p++;
+            n++;
+        }
+
+        if (p == end) break;
+
+        /* run of non-ascii characters */
+        do {
+            n += utf16_to_utf8_char<Write>(Write ? out + n : NULL, &p, end);
+        } while (p < end && *p >= 0x80);
+    }
+
+    *pp = p;
+    return n;
+}
+
+template <bool Write>
+static size_t utf8_to_utf16_scalar(
+    char16_t* out,
+    const unsigned char* p,
+    size_t len
+) {
+    return utf8_to_utf16_run<Write, false>(out, &p, p + len);
 }
 
-static size_t utf8_len_from_utf16(const char16_t* s)
+template <bool Write>
+static size_t utf16_to_utf8_scalar(
+    char* out,
+    const char16_t* p,
+    size_t len
+) {
+    return utf16_to_utf8_run<Write, false>(out, &p, p + len);
+}
+
+#ifdef STRCONV_X86
+
+/* ---------------- two-byte characters ---------------- */
+
+/*
+ * 8 utf-16 units below U+0800 -> 8..16 bytes of utf-8 (latin, greek,
+ * cyrillic...). each unit is made into 2 bytes, and the second one is
+ * dropped for ascii by a shuffle chosen by the mask of non-ascii units.
+ */
+struct strconv_shuffle_table {
+    unsigned char index[256][16];
+};
+
+static constexpr strconv_shuffle_table make_two_byte_table()
 {
-    size_t len = 0;
-    while (*s) {
-        uint32_t cp = utf16_decode(&s);
-        if (cp < 0x80) len += 1;
-        else if (cp < 0x800) len += 2;
-        else if (cp < 0x10000) len += 3;
-        else len += 4;
+    strconv_shuffle_table t = {};
+
+    for (int mask = 0; mask < 256; mask++) {
+        int k = 0;
+
+        for (int i = 0; i < 8; i++) {
+            t.index[mask][k++] = (unsigned char)(i * 2);
+
+            if (mask & (1 << i))
+                t.index[mask][k++] = (unsigned char)(i * 2 + 1);
+        }
+
+        while (k < 16)
+            t.index[mask][k++] = 0x80;
     }
-    return len;
+
+    return t;
 }
 
-char* utf16_to_utf8(char* out, char16_t const* input)
+alignas(16) static constexpr strconv_shuffle_table two_byte_table = make_two_byte_table();
+
+/* units of v must be below U+0800. writes 16 bytes, returns bytes converted. */
+template <bool Write>
+__attribute__((target("sse4.1")))
+static inline size_t utf16_to_utf8_two_byte(char* out, __m128i v)
 {
-    if (!input) return NULL;
+    __m128i ascii = _mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16((short)0xFF80)),
+                                    _mm_setzero_si128());
+    unsigned mask = ~(unsigned)_mm_movemask_epi8(_mm_packs_epi16(ascii, ascii)) & 0xFF;
 
-    size_t len = utf8_len_from_utf16(input);
-    if (!out) {
-        out = (char*)malloc(len + 1);
-        if (!out) return NULL;
+    if (Write) {
+        __m128i lead = _mm_or_si128(_mm_srli_epi16(v, 6), _mm_set1_epi16(0xC0));
+        __m128i cont = _mm_or_si128(_mm_and_si128(v, _mm_set1_epi16(0x3F)), _mm_set1_epi16(0x80));
+        __m128i two = _mm_or_si128(lead, _mm_slli_epi16(cont, 8));
+
+        __m128i bytes = _mm_blendv_epi8(two, v, ascii);
+        __m128i shuffle = _mm_load_si128((const __m128i*)two_byte_table.index[mask]);
+
+        _mm_storeu_si128((__m128i*)out, _mm_shuffle_epi8(bytes, shuffle));
+    }
+
+    return 8 + __builtin_popcount(mask);
+}
+
+/* ---------------- SSE4.1 ---------------- */
+
+template <bool Write>
+__attribute__((target("sse4.1")))
+static size_t utf8_to_utf16_sse4(
+    char16_t* out,
+    const unsigned char* p,
+    size_t len
+) {
+    const unsigned char* end = p + len;
+    size_t n = 0;
+
+    while (p < end) {
+        while (end - p >= 16) {
+            __m128i v = _mm_loadu_si128((const __m128i*)p);
+
+            if (_mm_movemask_epi8(v) != 0)
+                break;
+
+            if (Write) {
+                _mm_storeu_si128((__m128i*)(out + n), _mm_cvtepu8_epi16(v));
+                _mm_storeu_si128((__m128i*)(out + n + 8),
+                                 _mm_cvtepu8_epi16(_mm_srli_si128(v, 8)));
+            }
+            p += 16;
+            n += 16;
+        }
+
+        if (p == end) break;
+
+        n += utf8_to_utf16_run<Write, true>(Write ? out + n : NULL, &p, end);
     }
 
-    char* dst = out;
-    const char16_t* p = input;
-
-    while (*p) {
-        uint32_t cp = utf16_decode(&p);
-
-        if (cp < 0x80) {
-            *dst++ = (char)cp;
-        } else if (cp < 0x800) {
-            *dst++ = (char)(0xC0 | (cp >> 6));
-            *dst++ = (char)(0x80 | (cp & 0x3F));
-        } else if (cp < 0x10000) {
-            *dst++ = (char)(0xE0 | (cp >> 12));
-            *dst++ = (char)(0x80 | ((cp >> 6) & 0x3F));
-            *dst++ = (char)(0x80 | (cp & 0x3F));
-        } else {
-            *dst++ = (char)(0xF0 | (cp >> 18));
-            *dst++ = (char)(0x80 | ((cp >> 12) & 0x3F));
-            *dst++ = (char)(0x80 | ((cp >> 6) & 0x3F));
-            *dst++ = (char)(0x80 | (cp & 0x3F));
+    return n;
+}
+
+template <bool Write>
+__attribute__((target("sse4.1")))
+static size_t utf16_to_utf8_sse4(
+    char* out,
+    const char16_t* p,
+    size_t len
+) {
+    const char16_t* end = p + len;
+    const __m128i non_ascii = _mm_set1_epi16((short)0xFF80);
+    const __m128i two_byte = _mm_set1_epi16((short)0xF800);
+    size_t n = 0;
+
+    while (p < end) {
+        while (end - p >= 16) {
+            __m128i a = _mm_loadu_si128((const __m128i*)p);
+            __m128i b = _mm_loadu_si128((const __m128i*)(p + 8));
+
+            if (!_mm_testz_si128(_mm_or_si128(a, b), non_ascii)) {
+                /* first 8 units are below U+0800. (the rest of input is 8
+                   units at least, so 16 bytes can be written) */
+                if (!_mm_testz_si128(a, two_byte))
+                    break;
+
+                n += utf16_to_utf8_two_byte<Write>(Write ? out + n : NULL, a);
+                p += 8;
+                continue;
+            }
+
+            if (Write)
+                _mm_storeu_si128((__m128i*)(out + n), _mm_packus_epi16(a, b));
+            p += 16;
+            n += 16;
         }
+
+        if (p == end) break;
+
+        n += utf16_to_utf8_run<Write, true>(Write ? out + n : NULL, &p, end);
     }
-    *dst = '\0';
-    return out;
+
+    return n;
 }
 
-char16_t* utf8_to_utf16_with_len(
+/* ---------------- AVX2 ---------------- */
+
+template <bool Write>
+__attribute__((target("avx2")))
+static size_t utf8_to_utf16_avx2(
     char16_t* out,
-    char const* input,
+    const unsigned char* p,
     size_t len
 ) {
-    if (!input) return NULL;
-
-    const unsigned char* p =
-        (const unsigned char*)input;
     const unsigned char* end = p + len;
+    size_t n = 0;
 
-    /* サイズ計算 */
-    size_t out_len = 0;
-    {
-        const unsigned char* t = p;
-        while (t < end) {
-            uint32_t cp = utf8_decode_len(&t, end);
-            out_len += (cp >= 0x10000) ? 2 : 1;
+    while (p < end) {
+        while (end - p >= 32) {
+            __m256i v = _mm256_loadu_si256((const __m256i*)p);
+
+            if (_mm256_movemask_epi8(v) != 0)
+                break;
+
+            if (Write) {
+                _mm256_storeu_si256((__m256i*)(out + n),
+                                    _mm256_cvtepu8_epi16(_mm256_castsi256_si128(v)));
+                _mm256_storeu_si256((__m256i*)(out + n + 16),
+                                    _mm256_cvtepu8_epi16(_mm256_extracti128_si256(v, 1)));
+            }
+            p += 32;
+            n += 32;
         }
-    }
 
-    if (!out) {
-        out = (char16_t*)malloc(
-            (out_len + 1) * sizeof(char16_t)
-        );
-        if (!out) return NULL;
+        if (p == end) break;
+
+        n += utf8_to_utf16_run<Write, true>(Write ? out + n : NULL, &p, end);
     }
 
-    char16_t* dst = out;
+    return n;
+}
+
+template <bool Write>
+__attribute__((target("avx2")))
+static size_t utf16_to_utf8_avx2(
+    char* out,
+    const char16_t* p,
+    size_t len
+) {
+    const char16_t* end = p + len;
+    const __m256i non_ascii = _mm256_set1_epi16((short)0xFF80);
+    const __m128i two_byte = _mm_set1_epi16((short)0xF800);
+    size_t n = 0;
+
     while (p < end) {
-        uint32_t cp = utf8_decode_len(&p, end);
-        if (cp <= 0xFFFF) {
-            *dst++ = (char16_t)cp;
-        } else {
-            cp -= 0x10000;
-            *dst++ = (char16_t)(0xD800 | (cp >> 10));
-            *dst++ = (char16_t)(0xDC00 | (cp & 0x3FF));
+        while (end - p >= 32) {
+            __m256i a = _mm256_loadu_si256((const __m256i*)p);
+            __m256i b = _mm256_loadu_si256((const __m256i*)(p + 16));
+
+            if (!_mm256_testz_si256(_mm256_or_si256(a, b), non_ascii)) {
+                /* same as sse4, by 8 units */
+                __m128i h = _mm256_castsi256_si128(a);
+
+                if (!_mm_testz_si128(h, two_byte))
+                    break;
+
+                n += utf16_to_utf8_two_byte<Write>(Write ? out + n : NULL, h);
+                p += 8;
+                continue;
+            }
+
+            /* packus works in 128-bit lanes: fix the order */
+            if (Write)
+                _mm256_storeu_si256((__m256i*)(out + n),
+                                    _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8));
+            p += 32;
+            n += 32;
         }
+
+        if (p == end) break;
+
+        n += utf16_to_utf8_run<Write, true>(Write ? out + n : NULL, &p, end);
+    }
+
+    return n;
+}
+
+#endif /* STRCONV_X86 */
+
+/* ---------------- dispatch ---------------- */
+
+struct strconv_kernels {
+    size_t (*utf8_to_utf16)(char16_t*, const unsigned char*, size_t);
+    size_t (*utf8_to_utf16_count)(char16_t*, const unsigned char*, size_t);
+    size_t (*utf16_to_utf8)(char*, const char16_t*, size_t);
+    size_t (*utf16_to_utf8_count)(char*, const char16_t*, size_t);
+};
+
+#define STRCONV_KERNELS(name) { \
+    utf8_to_utf16_##name<true>, utf8_to_utf16_##name<false>, \
+    utf16_to_utf8_##name<true>, utf16_to_utf8_##name<false> }
+
+static const strconv_kernels kernels[] = {
+    STRCONV_KERNELS(scalar),
+#ifdef STRCONV_X86
+    STRCONV_KERNELS(sse4),
+    STRCONV_KERNELS(avx2),
+#endif
+};
+
+/* scalar until the cpu is checked at startup. */
+static strconv_impl active_impl = STRCONV_SCALAR;
+static const strconv_kernels* active = &kernels[STRCONV_SCALAR];
+
+static bool strconv_supported(strconv_impl impl)
+{
+    switch (impl) {
+        case STRCONV_SCALAR:
+            return true;
+#ifdef STRCONV_X86
+        case STRCONV_SSE4:
+            return __builtin_cpu_supports("sse4.1");
+        case STRCONV_AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+bool strconv_set_impl(strconv_impl impl)
+{
+    if (!strconv_supported(impl)) return false;
+
+    active_impl = impl;
+    active = &kernels[impl];
+    return true;
+}
+
+strconv_impl strconv_get_impl()
+{
+    return active_impl;
+}
+
+char const* strconv_impl_name(strconv_impl impl)
+{
+    switch (impl) {
+        case STRCONV_SCALAR: return "scalar";
+        case STRCONV_SSE4: return "sse4";
+        case STRCONV_AVX2: return "avx2";
+    }
+    return "?";
+}
+
+static const bool strconv_initialized =
+    strconv_set_impl(STRCONV_AVX2) || strconv_set_impl(STRCONV_SSE4);
+
+/* ---------------- API ---------------- */
+
+char16_t* utf8_to_utf16(char16_t* out, char const* input)
+{
+    if (!input) return NULL;
+
+    return utf8_to_utf16_with_len(out, input, strlen(input));
+}
+
+char* utf16_to_utf8(char* out, char16_t const* input)
+{
+    if (!input) return NULL;
+
+    return utf16_to_utf8_with_len(
+        out, input, std::char_traits<char16_t>::length(input));
+}
+
+char16_t* utf8_to_utf16_with_len(
+    char16_t* out,
+    char const* input,
+    size_t len
+) {
+    if (!input) return NULL;
+
+    const unsigned char* p = (const unsigned char*)input;
+
+    if (!out) {
+        size_t out_len = active->utf8_to_utf16_count(NULL, p, len);
+        out = (char16_t*)malloc((out_len + 1) * sizeof(char16_t));
+        if (!out) return NULL;
     }
-    *dst = 0;
+
+    out[active->utf8_to_utf16(out, p, len)] = 0;
     return out;
 }
 
@@ -255,47 +610,58 @@ char* utf16_to_utf8_with_len(
 ) {
     if (!input) return NULL;
 
-    const char16_t* p = input;
-    const char16_t* end = input + len;
-
-    /* サイズ計算 */
-    size_t out_len = 0;
-    {
-        const char16_t* t = p;
-        while (t < end) {
-            uint32_t cp = utf16_decode(&t);
-            if (cp < 0x80) out_len += 1;
-            else if (cp < 0x800) out_len += 2;
-            else if (cp < 0x10000) out_len += 3;
-            else out_len += 4;
-        }
-    }
-
     if (!out) {
+        size_t out_len = active->utf16_to_utf8_count(NULL, input, len);
         out = (char*)malloc(out_len + 1);
         if (!out) return NULL;
     }
 
-    char* dst = out;
-    while (p < end) {
-        uint32_t cp = utf16_decode(&p);
-
-        if (cp < 0x80) {
-            *dst++ = (char)cp;
-        } else if (cp < 0x800) {
-            *dst++ = (char)(0xC0 | (cp >> 6));
-            *dst++ = (char)(0x80 | (cp & 0x3F));
-        } else if (cp < 0x10000) {
-            *dst++ = (char)(0xE0 | (cp >> 12));
-            *dst++ = (char)(0x80 | ((cp >> 6) & 0x3F));
-            *dst++ = (char)(0x80 | (cp & 0x3F));
-        } else {
-            *dst++ = (char)(0xF0 | (cp >> 18));
-            *dst++ = (char)(0x80 | ((cp >> 12) & 0x3F));
-            *dst++ = (char)(0x80 | ((cp >> 6) & 0x3F));
-            *dst++ = (char)(0x80 | (cp & 0x3F));
-        }
-    }
-    *dst = '\0';
+    out[active->utf16_to_utf8(out, input, len)] = '\0';
     return out;
 }
+
+size_t utf8_to_utf16_length(char const* input, size_t len)
+{
+    return active->utf8_to_utf16_count(NULL, (const unsigned char*)input, len);
+}
+
+size_t utf16_to_utf8_length(char16_t const* input, size_t len)
+{
+    return active->utf16_to_utf8_count(NULL, input, len);
+}
+
+size_t utf8_to_utf16_into(char16_t* out, char const* input, size_t len)
+{
+    return active->utf8_to_utf16(out, (const unsigned char*)input, len);
+}
+
+size_t utf16_to_utf8_into(char* out, char16_t const* input, size_t len)
+{
+    return active->utf16_to_utf8(out, input, len);
+}
+
+/*
+ * appending is one pass into the upper bound of the length.
+ * utf8 -> utf16 never grows, but utf16 -> utf8 may be 3 times; long inputs
+ * are counted first, so that the string doesn't keep the unused capacity.
+ */
+#define STRCONV_APPEND_BOUND_MAX 1024
+
+void utf8_to_utf16_append(std::u16string& out, char const* input, size_t len)
+{
+    size_t pos = out.size();
+
+    out.resize(pos + utf8_to_utf16_max_length(len));
+    out.resize(pos + utf8_to_utf16_into(&out[pos], input, len));
+}
+
+void utf16_to_utf8_append(std::string& out, char16_t const* input, size_t len)
+{
+    size_t pos = out.size();
+
+    out.resize(pos + (len <= STRCONV_APPEND_BOUND_MAX
+                          ? utf16_to_utf8_max_length(len)
+                          : utf16_to_utf8_length(input, len)));
+
+    out.resize(pos + utf16_to_utf8_into(&out[pos], input, len));
+}
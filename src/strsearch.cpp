@@ -0,0 +1,215 @@
+#include <string.h>
+#include <string_view>
+#include "strconv.hpp"
+#include "strsearch.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define STRSEARCH_X86 1
+#include <immintrin.h>
+#endif
+
+/*
+ * SIMD kernels filter candidates by the first and the last unit of the
+ * needle: a block of positions is compared with both at once, and only
+ * positions where both match are compared fully.
+ *
+ * kernels return the index, or U16_NPOS. needle_len is not 0.
+ */
+
+static inline bool u16_equal(const char16_t* a, const char16_t* b, size_t len)
+{
+    return memcmp(a, b, len * sizeof(char16_t)) == 0;
+}
+
+/* ---------------- scalar ---------------- */
+
+/* same as std::u16string_view. (search of the first unit, then compare) */
+static size_t u16_find_scalar(
+    const char16_t* hay, size_t len,
+    const char16_t* needle, size_t m
+) {
+    size_t r = std::u16string_view(hay, len).find(needle, 0, m);
+    return r == std::u16string_view::npos ? U16_NPOS : r;
+}
+
+static size_t u16_rfind_scalar(
+    const char16_t* hay, size_t len,
+    const char16_t* needle, size_t m
+) {
+    size_t r = std::u16string_view(hay, len).rfind(needle, std::u16string_view::npos, m);
+    return r == std::u16string_view::npos ? U16_NPOS : r;
+}
+
+#ifdef STRSEARCH_X86
+
+/* ---------------- SSE4.1 ---------------- */
+
+/* candidates of 8 positions from i. (2 bits for each) */
+__attribute__((target("sse4.1")))
+static inline unsigned candidates_sse4(
+    const char16_t* p, size_t m, __m128i first, __m128i last
+) {
+    __m128i a = _mm_loadu_si128((const __m128i*)p);
+    __m128i b = _mm_loadu_si128((const __m128i*)(p + m - 1));
+
+    return (unsigned)_mm_movemask_epi8(
+        _mm_and_si128(_mm_cmpeq_epi16(a, first), _mm_cmpeq_epi16(b, last)));
+}
+
+__attribute__((target("sse4.1")))
+static size_t u16_find_sse4(
+    const char16_t* hay, size_t len,
+    const char16_t* needle, size_t m
+) {
+    const __m128i first = _mm_set1_epi16((short)needle[0]);
+    const __m128i last = _mm_set1_epi16((short)needle[m - 1]);
+
+    size_t i = 0;
+
+    for (; i + m - 1 + 8 <= len; i += 8) {
+        unsigned mask = candidates_sse4(hay + i, m, first, last) & 0x5555;
+
+        while (mask) {
+            size_t k = i + __builtin_ctz(mask) / 2;
+
+            if (u16_equal(hay + k, needle, m))
+                return k;
+
+            mask &= mask - 1;
+        }
+    }
+
+    size_t r = u16_find_scalar(hay + i, len - i, needle, m);
+    return r == U16_NPOS ? r : i + r;
+}
+
+__attribute__((target("sse4.1")))
+static size_t u16_rfind_sse4(
+    const char16_t* hay, size_t len,
+    const char16_t* needle, size_t m
+) {
+    const __m128i first = _mm_set1_epi16((short)needle[0]);
+    const __m128i last = _mm_set1_epi16((short)needle[m - 1]);
+
+    /* positions [0, end) are left */
+    size_t end = len - m + 1;
+
+    for (; end >= 8; end -= 8) {
+        size_t i = end - 8;
+        unsigned mask = candidates_sse4(hay + i, m, first, last) & 0x5555;
+
+        while (mask) {
+            unsigned bit = 31 - __builtin_clz(mask);
+            size_t k = i + bit / 2;
+
+            if (u16_equal(hay + k, needle, m))
+                return k;
+
+            mask &= ~(1u << bit);
+        }
+    }
+
+    return u16_rfind_scalar(hay, end + m - 1, needle, m);
+}
+
+/* ---------------- AVX2 ---------------- */
+
+__attribute__((target("avx2")))
+static inline unsigned candidates_avx2(
+    const char16_t* p, size_t m, __m256i first, __m256i last
+) {
+    __m256i a = _mm256_loadu_si256((const __m256i*)p);
+    __m256i b = _mm256_loadu_si256((const __m256i*)(p + m - 1));
+
+    return (unsigned)_mm256_movemask_epi8(
+        _mm256_and_si256(_mm256_cmpeq_epi16(a, first), _mm256_cmpeq_epi16(b, last)));
+}
+
+__attribute__((target("avx2")))
+static size_t u16_find_avx2(
+    const char16_t* hay, size_t len,
+    const char16_t* needle, size_t m
+) {
+    const __m256i first = _mm256_set1_epi16((short)needle[0]);
+    const __m256i last = _mm256_set1_epi16((short)needle[m - 1]);
+
+    size_t i = 0;
+
+    for (; i + m - 1 + 16 <= len; i += 16) {
+        unsigned mask = candidates_avx2(hay + i, m, first, last) & 0x55555555;
+
+        while (mask) {
+            size_t k = i + __builtin_ctz(mask) / 2;
+
+            if (u16_equal(hay + k, needle, m))
+                return k;
+
+            mask &= mask - 1;
+        }
+    }
+
+    size_t r = u16_find_scalar(hay + i, len - i, needle, m);
+    return r == U16_NPOS ? r : i + r;
+}
+
+__attribute__((target("avx2")))
+static size_t u16_rfind_avx2(
+    const char16_t* hay, size_t len,
+    const char16_t* needle, size_t m
+) {
+    const __m256i first = _mm256_set1_epi16((short)needle[0]);
+    const __m256i last = _mm256_set1_epi16((short)needle[m - 1]);
+
+    size_t end = len - m + 1;
+
+    for (; end >= 16; end -= 16) {
+        size_t i = end - 16;
+        unsigned mask = candidates_avx2(hay + i, m, first, last) & 0x55555555;
+
+        while (mask) {
+            unsigned bit = 31 - __builtin_clz(mask);
+            size_t k = i + bit / 2;
+
+            if (u16_equal(hay + k, needle, m))
+                return k;
+
+            mask &= ~(1u << bit);
+        }
+    }
+
+    return u16_rfind_scalar(hay, end + m - 1, needle, m);
+}
+
+#endif /* STRSEARCH_X86 */
+
+/* ---------------- dispatch ---------------- */
+
+struct strsearch_kernels {
+    size_t (*find)(const char16_t*, size_t, const char16_t*, size_t);
+    size_t (*rfind)(const char16_t*, size_t, const char16_t*, size_t);
+};
+
+/* indexed by strconv_impl */
+static const strsearch_kernels kernels[] = {
+    { u16_find_scalar, u16_rfind_scalar },
+#ifdef STRSEARCH_X86
+    { u16_find_sse4, u16_rfind_sse4 },
+    { u16_find_avx2, u16_rfind_avx2 },
+#endif
+};
+
+size_t u16_find(char16_t const* hay, size_t len, char16_t const* needle, size_t needle_len)
+{
+    if (needle_len == 0) return 0;
+    if (needle_len > len) return U16_NPOS;
+
+    return kernels[strconv_get_impl()].find(hay, len, needle, needle_len);
+}
+
+size_t u16_rfind(char16_t const* hay, size_t len, char16_t const* needle, size_t needle_len)
+{
+    if (needle_len == 0) return len;
+    if (needle_len > len) return U16_NPOS;
+
+    return kernels[strconv_get_impl()].rfind(hay, len, needle, needle_len);
+}
@@ -0,0 +1,26 @@
+#
+# cmake -DFIRE=<fire> -DINPUT=<file.fire> -P check_error.cmake
+#
+# fire must exit with 1 (error reported), and print the message of first line.
+
+file(STRINGS ${INPUT} first LIMIT_COUNT 1)
+
+if(NOT first MATCHES "^// error: (.+)$")
+  message(FATAL_ERROR "${INPUT}: first line must be \"// error: <message>\"")
+endif()
+
+set(expected ${CMAKE_MATCH_1})
+
+execute_process(
+  COMMAND ${FIRE} ${INPUT}
+  RESULT_VARIABLE code
+  OUTPUT_VARIABLE out
+  ERROR_VARIABLE out)
+
+if(NOT code STREQUAL "1")
+  message(FATAL_ERROR "${INPUT}: exit ${code}, expected 1\n${out}")
+endif()
+
+if(NOT out MATCHES "${expected}")
+  message(FATAL_ERROR "${INPUT}: expected \"${expected}\" in output\n${out}")
+endif()
@@ -0,0 +1,46 @@
+#
+# sh namespace.sh <fire> <work folder>
+#
+# a namespace split across two imported files. these files are parsed again
+# at each build, and the daemon must survive the second request.
+
+set -u
+
+FIRE=$1
+WORK=$2
+SOCK=$WORK/daemon.sock
+
+rm -rf "$WORK"
+mkdir -p "$WORK"
+cp "$(dirname "$0")"/namespace/*.fire "$WORK"
+
+"$FIRE" --daemon --socket="$SOCK" > "$WORK/daemon.log" 2>&1 &
+DAEMON=$!
+
+trap 'kill $DAEMON 2> /dev/null' EXIT
+
+for i in 1 2 3 4 5 6 7 8 9 10; do
+  [ -S "$SOCK" ] && break
+  sleep 0.1
+done
+
+cd "$WORK"
+
+"$FIRE" --client --socket="$SOCK" main.fire
+first=$?
+
+echo "// changed" >> main.fire
+
+"$FIRE" --client --socket="$SOCK" main.fire
+second=$?
+
+if ! kill -0 $DAEMON 2> /dev/null; then
+  echo "daemon is dead after second request."
+  cat "$WORK/daemon.log"
+  exit 1
+fi
+
+if [ $first -ne $second ]; then
+  echo "exit code changed: $first -> $second"
+  exit 1
+fi